@@ -0,0 +1,169 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_BLOCK_DIAGONAL_MATRIX_HH
+# define HPP_PINOCCHIO_BLOCK_DIAGONAL_MATRIX_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Square block diagonal matrix
+    ///
+    /// This is the structure of the Jacobians of the operations on a
+    /// cartesian product of Lie groups. Blocks corresponding to vector spaces
+    /// are plus or minus identity and are not stored. Blocks corresponding to
+    /// \f$SO(n)\f$ and \f$SE(n)\f$ are small dense matrices.
+    ///
+    /// The matrix is filled block by block, from the top left corner, with
+    /// pushIdentity and pushDense. Memory is allocated only when the size
+    /// increases.
+    /// \sa LiegroupSpace::Jintegrate, LiegroupSpace::Jdifference
+    class HPP_PINOCCHIO_DLLAPI BlockDiagonalMatrix
+    {
+      public:
+        /// Maximal size of a dense block
+        enum { MaxDenseSize = 6 };
+
+        /// Diagonal block
+        struct Block {
+          enum Kind_t {
+            /// Identity matrix
+            IDENTITY,
+            /// Opposite of identity matrix
+            MINUS_IDENTITY,
+            /// Dense matrix
+            DENSE
+          };
+          Kind_t kind;
+          /// Index of the first row and column of the block
+          size_type index;
+          /// Number of rows and columns of the block
+          size_type size;
+        };
+        typedef std::vector <Block> Blocks_t;
+
+        /// Constructor of an empty matrix
+        BlockDiagonalMatrix () : size_ (0), end_ (0), blocks_ (), dense_ () {}
+
+        /// Constructor
+        /// \param size number of rows and columns.
+        explicit BlockDiagonalMatrix (const size_type& size);
+
+        /// Set the size and remove all blocks
+        void resize (const size_type& size);
+
+        /// Number of rows and columns
+        size_type size () const
+        {
+          return size_;
+        }
+
+        /// Get the diagonal blocks
+        const Blocks_t& blocks () const
+        {
+          return blocks_;
+        }
+
+        /// Get a dense block
+        /// \param block a block of kind Block::DENSE.
+        Eigen::Block <const matrix_t> dense (const Block& block) const
+        {
+          assert (block.kind == Block::DENSE);
+          return dense_.block (block.index, 0, block.size, block.size);
+        }
+
+        /// Append an identity block
+        /// \param size number of rows and columns of the block,
+        /// \param minus whether to append the opposite of identity.
+        void pushIdentity (const size_type& size, bool minus = false);
+
+        /// Append a dense block
+        /// \param block a square matrix of size at most MaxDenseSize.
+        template <typename Derived>
+        void pushDense (const Eigen::MatrixBase <Derived>& block)
+        {
+          assert (block.rows () == block.cols ());
+          assert (block.rows () <= MaxDenseSize);
+          assert (end_ + block.rows () <= size_);
+          Block b; b.kind = Block::DENSE; b.index = end_; b.size = block.rows ();
+          dense_.block (b.index, 0, b.size, b.size) = block;
+          blocks_.push_back (b);
+          end_ += b.size;
+        }
+
+        /// Compute \f$ J \leftarrow B J \f$ where B is this matrix
+        void applyOnTheLeft (matrixOut_t J) const;
+
+        /// Compute \f$ J \leftarrow J B \f$ where B is this matrix
+        void applyOnTheRight (matrixOut_t J) const;
+
+        /// Dense representation of the matrix
+        matrix_t matrix () const;
+
+        /// Compute \f$ J_{rows} \leftarrow B J_{rows} \f$ without memory
+        /// allocation, where \f$ J_{rows} \f$ are the rows of J starting at
+        /// index and B is a square matrix of size at most MaxDenseSize.
+        template <typename Derived>
+        static void applyDenseOnTheLeft (const Eigen::MatrixBase <Derived>& B,
+                                         const size_type& index,
+                                         matrixOut_t J)
+        {
+          Eigen::Matrix <value_type, Eigen::Dynamic, 1, 0, MaxDenseSize, 1>
+            tmp (B.rows ());
+          for (size_type c = 0; c < J.cols (); ++c) {
+            tmp.noalias () = B * J.col (c).segment (index, B.cols ());
+            J.col (c).segment (index, B.rows ()) = tmp;
+          }
+        }
+
+        /// Compute \f$ J_{cols} \leftarrow J_{cols} B \f$ without memory
+        /// allocation, where \f$ J_{cols} \f$ are the columns of J starting
+        /// at index and B is a square matrix of size at most MaxDenseSize.
+        template <typename Derived>
+        static void applyDenseOnTheRight (const Eigen::MatrixBase <Derived>& B,
+                                          const size_type& index,
+                                          matrixOut_t J)
+        {
+          Eigen::Matrix <value_type, 1, Eigen::Dynamic, Eigen::RowMajor, 1,
+                         MaxDenseSize> tmp (B.cols ());
+          for (size_type r = 0; r < J.rows (); ++r) {
+            tmp.noalias () = J.row (r).segment (index, B.rows ()) * B;
+            J.row (r).segment (index, B.cols ()) = tmp;
+          }
+        }
+
+      private:
+        /// Number of rows and columns
+        size_type size_;
+        /// Index of the end of the last block
+        size_type end_;
+        Blocks_t blocks_;
+        /// Storage of dense blocks: the block at index i is stored in rows
+        /// i to i + size - 1.
+        matrix_t dense_;
+    }; // class BlockDiagonalMatrix
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_BLOCK_DIAGONAL_MATRIX_HH
@@ -23,6 +23,7 @@
 
 # include <hpp/pinocchio/fwd.hh>
 # include <hpp/pinocchio/device.hh>
+# include <hpp/pinocchio/compact-jacobian.hh>
 
 namespace hpp {
   namespace pinocchio {
@@ -38,10 +39,22 @@ namespace hpp {
     /// context, the kinematic tree contains several robots and objects.
     /// This class enables users to compute the center of mass of only one
     /// robot or object.
+    ///
+    /// Only the joints of the subtrees and their ancestors are visited by
+    /// method \c compute, so that the cost does not depend on the size of
+    /// the rest of the kinematic tree.
+    ///
+    /// Method \c compute is incremental: the placement of each visited joint
+    /// is compared to the one of the previous call and only the subtrees of
+    /// the joints that moved, and the Jacobian columns of their ancestors,
+    /// are recomputed. Joints move when the configuration or the placement
+    /// of a joint in its parent changes. A change of the mass or of the
+    /// center of mass of a body triggers the full computation.
     class CenterOfMassComputation
     {
       public:
         typedef std::vector <JointIndex> JointRootIndexes_t;
+        typedef std::vector <JointIndex> JointIndexes_t;
         /// \cond
         // This fixes an alignment issue of se3::Data::hg
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -61,6 +74,12 @@ namespace hpp {
         void add (const JointPtr_t& rootOfSubtree);
 
         /// Compute the center of mass and Jacobian of the sub-trees.
+        ///
+        /// The forward kinematics of the robot must be up to date.
+        /// If the previous call computed at least what \c flag requires and
+        /// less than half of the visited joints moved since, the
+        /// contributions of the subtrees that moved are replaced, instead
+        /// of computing everything again.
         void compute (const Device::Computation_t& flag
             = Device::ALL);
 
@@ -70,8 +89,17 @@ namespace hpp {
         const value_type&    mass        () const { return data.mass[0]; }
         /// Get Jacobian of center of mass of the sub-tree.
         const ComJacobian_t& jacobian    () const { return data.Jcom   ; }
+        /// Get Jacobian of center of mass of the sub-tree, in compact form.
+        /// Only the columns of the joints returned by method joints are
+        /// stored, the other columns being zero.
+        const CompactJacobian& compactJacobian () const
+        { return compactJacobian_; }
         /// Get const reference to the vector of sub-tree roots.
         const JointRootIndexes_t & roots () const { return roots_; }
+        /// Get const reference to the joints visited by method compute.
+        /// These are the joints of the subtrees and their ancestors,
+        /// sorted by increasing index.
+        const JointIndexes_t & joints () const { return joints_; }
 
         ~CenterOfMassComputation ();
 
@@ -79,9 +107,38 @@ namespace hpp {
         CenterOfMassComputation (const DevicePtr_t& device);
 
       private:
+        enum ChangeStatus_t {
+          NOT_CHANGED = 0,
+          CHANGED,          // the joint or one of its ancestors moved
+          ANCESTOR_CHANGED  // the joint is an ancestor of a joint that moved
+        };
+
+        void initialize (const std::size_t& i);
+        void backwardStep (const JointIndex& jid, bool computeJac);
+        void computeAll (bool computeJac);
+        /// Fill changed_ and changedRoots_
+        /// \return false if the full computation is cheaper.
+        bool findChangedJoints ();
+        void computeIncremental (bool computeJac);
+
         DevicePtr_t robot_;
         // Root of the subtrees
         JointRootIndexes_t roots_;
+        // Joints of the subtrees and their ancestors, sorted by increasing
+        // index.
+        JointIndexes_t joints_;
+        // Whether joints_[i] belongs to a subtree (and is not only an ancestor)
+        std::vector <bool> inSubtree_;
+        // Whether the result corresponds to the placements stored in data.oMi
+        bool upToDate_, jacobianUpToDate_;
+        // ChangeStatus_t of each joint of the model
+        std::vector <char> changed_;
+        // Joints that moved, and whose ancestors did not.
+        JointIndexes_t changedRoots_;
+        // Mass and center of mass of the bodies used by the last computation
+        std::vector <value_type> masses_;
+        std::vector <vector3_t> levers_;
+        CompactJacobian compactJacobian_;
         // Specific pinocchio Data to store the computation results
         Data data;
 
@@ -0,0 +1,90 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_COMPACT_JACOBIAN_HH
+# define HPP_PINOCCHIO_COMPACT_JACOBIAN_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Jacobian of which most columns are zero
+    ///
+    /// Only the non-zero columns are stored, in a dense matrix, together with
+    /// their indices in the full Jacobian. Products are computed on the
+    /// non-zero columns only.
+    class HPP_PINOCCHIO_DLLAPI CompactJacobian
+    {
+      public:
+        typedef std::vector <size_type> ColumnIndexes_t;
+
+        /// Constructor of an empty Jacobian
+        CompactJacobian () : matrix_ (), columns_ (), cols_ (0) {}
+
+        /// Set the non-zero columns
+        /// \param rows number of rows,
+        /// \param cols number of columns of the full Jacobian,
+        /// \param columns indices of the non-zero columns, sorted.
+        /// The stored columns are set to zero.
+        void setColumns (const size_type& rows, const size_type& cols,
+                         const ColumnIndexes_t& columns);
+
+        /// Number of rows
+        size_type rows () const { return matrix_.rows (); }
+        /// Number of columns of the full Jacobian
+        size_type cols () const { return cols_; }
+
+        /// Non-zero columns
+        const matrix_t& matrix () const { return matrix_; }
+        /// Non-zero columns
+        matrix_t& matrix () { return matrix_; }
+        /// Indices of the columns of matrix () in the full Jacobian
+        const ColumnIndexes_t& columns () const { return columns_; }
+
+        /// Compute \f$ result = J v \f$
+        /// \param v vector of size cols (),
+        /// \retval result vector of size rows ().
+        void multiply (vectorIn_t v, vectorOut_t result) const;
+
+        /// Compute \f$ result = J A \f$
+        /// \param A matrix with cols () rows,
+        /// \retval result matrix with rows () rows.
+        void multiplyMatrix (matrixIn_t A, matrixOut_t result) const;
+
+        /// Compute \f$ result = J^T w \f$
+        /// \param w vector of size rows (),
+        /// \retval result vector of size cols ().
+        void transposeMultiply (vectorIn_t w, vectorOut_t result) const;
+
+        /// Add the Jacobian to a dense matrix
+        /// \retval result matrix of size rows () x cols (), for instance a
+        ///         block of a stacked Jacobian.
+        void addTo (matrixOut_t result) const;
+
+        /// Full Jacobian
+        matrix_t dense () const;
+
+      private:
+        matrix_t matrix_;
+        ColumnIndexes_t columns_;
+        size_type cols_;
+    }; // class CompactJacobian
+  }  // namespace pinocchio
+}  // namespace hpp
+#endif // HPP_PINOCCHIO_COMPACT_JACOBIAN_HH
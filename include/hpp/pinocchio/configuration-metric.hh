@@ -0,0 +1,147 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_CONFIGURATION_METRIC_HH
+# define HPP_PINOCCHIO_CONFIGURATION_METRIC_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Weighted distance between configurations of a Device
+    ///
+    /// The squared distance is
+    /// \f{equation*}
+    /// d(\mathbf{q}_1,\mathbf{q}_2)^2 = \sum_{j} w_j^2 d_j(\mathbf{q}_1,\mathbf{q}_2)^2
+    ///   + \|\mathbf{q}_{2,extra} - \mathbf{q}_{1,extra}\|^2
+    /// \f}
+    /// where \f$d_j\f$ is the distance in the configuration space of joint
+    /// \f$j\f$, as computed by hpp::pinocchio::distance, and \f$w_j\f$ the
+    /// weight of the joint. With unit weights, this metric is the same as
+    /// hpp::pinocchio::distance.
+    ///
+    /// The layout of the configuration space is analysed once at
+    /// construction. Vector space joints are gathered in a vector of
+    /// coordinate weights so that their contribution is computed in a single
+    /// pass over the configuration.
+    class HPP_PINOCCHIO_DLLAPI ConfigurationMetric
+    {
+      public:
+        /// Create a metric with unit weights
+        static ConfigurationMetricPtr_t create (const DevicePtr_t& robot);
+
+        /// Squared distance between two configurations
+        value_type squaredDistance (ConfigurationIn_t q1,
+                                    ConfigurationIn_t q2) const;
+
+        /// Distance between two configurations
+        value_type distance (ConfigurationIn_t q1, ConfigurationIn_t q2) const;
+
+        /// Get the joint weights
+        /// \return a vector of size \c robot->getJointVector().size()
+        const vector_t& weights () const
+        {
+          return weights_;
+        }
+
+        /// Set the joint weights
+        /// \param weights a vector of size \c robot->getJointVector().size()
+        void weights (vectorIn_t weights);
+
+        /// Compute the joint weights from the kinematic chain
+        ///
+        /// The weight of a joint with rotational degrees of freedom is the
+        /// radius of the subtree it moves, i.e. the maximal distance from
+        /// the joint origin to a point of the bodies of the subtree, computed
+        /// from Joint::maximalDistanceToParent and Body::radius. It bounds
+        /// the displacement of the subtree due to a unit rotation. The
+        /// weight of a purely translational joint is 1. The weight of
+        /// free-flyer and planar joints, which also applies to their
+        /// translation, is not less than 1.
+        ///
+        /// \param massWeighted if true, the weights are multiplied by the
+        ///        mass of the subtree divided by the mass of the robot.
+        /// \param minimalWeight lower bound of the weights, so that no joint
+        ///        is ignored by the metric.
+        /// \note Body::radius requires the geometry data of the robot. If it
+        ///       is not available, the radii of the bodies are ignored.
+        void computeWeights (const bool massWeighted = false,
+                             const value_type& minimalWeight = 1e-2);
+
+        /// Get the robot
+        const DevicePtr_t& robot () const
+        {
+          return robot_;
+        }
+
+      protected:
+        ConfigurationMetric (const DevicePtr_t& robot);
+
+      private:
+        /// Kind of elementary configuration space
+        enum ElementType_t {
+          /// Vector space of translations
+          TRANSLATION,
+          /// Vector space of bounded rotations
+          ROTATION,
+          /// Unbounded rotation (cos, sin)
+          SO2,
+          /// Unit quaternion
+          SO3,
+          SE2,
+          SE3
+        };
+        struct Element {
+          ElementType_t type;
+          /// Rank of the joint in Device::getJointVector
+          size_type joint;
+          size_type iq, nq;
+        };
+        typedef std::vector<Element> Elements_t;
+
+        /// Element of non vector space type with precomputed squared weight
+        struct Segment {
+          ElementType_t type;
+          size_type iq;
+          value_type w2;
+        };
+        typedef std::vector<Segment> Segments_t;
+
+        struct ElementVisitor;
+
+        void computeElements ();
+        /// Update the coordinate weights and the segments from the joint
+        /// weights.
+        void update ();
+
+        DevicePtr_t robot_;
+        vector_t weights_;
+        Elements_t elements_;
+        /// Squared weights of vector space coordinates, 0 elsewhere.
+        vector_t coordinateWeights_;
+        Segments_t segments_;
+    }; // class ConfigurationMetric
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_CONFIGURATION_METRIC_HH
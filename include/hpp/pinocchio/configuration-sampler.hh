@@ -0,0 +1,127 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_CONFIGURATION_SAMPLER_HH
+# define HPP_PINOCCHIO_CONFIGURATION_SAMPLER_HH
+
+# include <vector>
+
+# include <boost/random/mersenne_twister.hpp>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Uniform sampling of configurations of a Device
+    ///
+    /// The configuration space is decomposed once, at construction, from
+    /// Device::configSpace:
+    /// \li vector space coordinates, including the extra configuration space,
+    ///     are sampled uniformly between their bounds,
+    /// \li \f$SO(2)\f$ components (unbounded rotations) are sampled uniformly
+    ///     on the unit circle,
+    /// \li \f$SO(3)\f$ components are sampled uniformly on the unit
+    ///     quaternions.
+    ///
+    /// Configurations are sampled by batches: the raw 32 bits integers of a
+    /// batch are drawn from the generator in one pass, then scaled to [0, 1)
+    /// and mapped to the configuration space component by component, for all
+    /// configurations at once, with Eigen array expressions.
+    ///
+    /// Bounds are read from the model and the extra configuration space at
+    /// each call, so they can be modified after construction. The dimension
+    /// of the configuration space must not change.
+    ///
+    /// Several independent random streams can be used concurrently, one per
+    /// thread. The streams are seeded from a single seed so that the result
+    /// is reproducible.
+    class HPP_PINOCCHIO_DLLAPI ConfigurationSampler
+    {
+      public:
+        typedef boost::random::mt19937 Generator_t;
+
+        /// Create a sampler
+        /// \param robot the robot,
+        /// \param seed seed of the random streams,
+        /// \param nbStreams number of independent random streams.
+        static ConfigurationSamplerPtr_t create (const DevicePtr_t& robot,
+            const unsigned int& seed = 0, const std::size_t& nbStreams = 1);
+
+        /// Sample configurations
+        /// \retval configurations a matrix of robot->configSize() rows. Each
+        ///         column is filled with a random configuration.
+        /// \param stream index of the random stream. Concurrent calls must
+        ///        use different streams.
+        /// \throw std::invalid_argument if the bounds of a vector space
+        ///        coordinate are not finite.
+        void sampleMany (matrixOut_t configurations,
+                         const std::size_t& stream = 0);
+
+        /// Sample one configuration
+        /// \sa sampleMany
+        void sample (ConfigurationOut_t configuration,
+                     const std::size_t& stream = 0);
+
+        /// Reset the random streams
+        void seed (const unsigned int& seed);
+
+        /// Number of random streams
+        std::size_t nbStreams () const
+        {
+          return generators_.size ();
+        }
+
+        /// Get the robot
+        const DevicePtr_t& robot () const
+        {
+          return robot_;
+        }
+
+      protected:
+        ConfigurationSampler (const DevicePtr_t& robot,
+            const unsigned int& seed, const std::size_t& nbStreams);
+
+      private:
+        /// Kind of elementary configuration space
+        enum ElementType_t {
+          /// Bounded vector space
+          VECTOR_SPACE,
+          /// Unbounded rotation (cos, sin)
+          SO2,
+          /// Unit quaternion
+          SO3
+        };
+        struct Element {
+          ElementType_t type;
+          size_type iq, nq;
+        };
+        typedef std::vector<Element> Elements_t;
+
+        struct ElementVisitor;
+
+        DevicePtr_t robot_;
+        Elements_t elements_;
+        std::vector<Generator_t> generators_;
+    }; // class ConfigurationSampler
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_CONFIGURATION_SAMPLER_HH
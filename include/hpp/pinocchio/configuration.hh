@@ -38,6 +38,11 @@ namespace hpp {
     /// \param robot robot that describes the kinematic chain
     /// \param[in,out] configuration initial and result configurations
     /// \retval saturation an array of boolean saying who saturated (size robot.numberDof()).
+    /// \return true if at least one coordinate was saturated.
+    ///
+    /// A degree of freedom is saturated if one of the configuration
+    /// coordinates mapped to it by Device::configToVelocityIndex is out of
+    /// bounds.
     bool saturate (const DevicePtr_t& robot,
                    ConfigurationOut_t configuration,
                    ArrayXb& saturation);
@@ -24,6 +24,10 @@
 # include <vector>
 # include <list>
 
+# include <boost/atomic.hpp>
+# include <boost/function.hpp>
+# include <boost/thread/recursive_mutex.hpp>
+
 # include <hpp/util/debug.hh>
 
 # include <hpp/pinocchio/fwd.hh>
@@ -114,13 +118,13 @@ namespace hpp {
       /// Set pinocchio geom.
       void geomModel( GeomModelPtr_t geomModelPtr ) { geomModel_ = geomModelPtr; }
       /// Access to pinocchio geomModel
-      GeomModelConstPtr_t        geomModelPtr() const { return geomModel_; }
+      GeomModelConstPtr_t        geomModelPtr() const { loadDeferredGeometry(); return geomModel_; }
       /// Access to pinocchio geomModel
-      GeomModelPtr_t             geomModelPtr() { return geomModel_; }
+      GeomModelPtr_t             geomModelPtr() { loadDeferredGeometry(); return geomModel_; }
       /// Access to pinocchio geomModel
-      const GeomModel & geomModel() const { assert(geomModel_); return *geomModel_; }
+      const GeomModel & geomModel() const { loadDeferredGeometry(); assert(geomModel_); return *geomModel_; }
       /// Access to pinocchio geomModel
-      GeomModel &       geomModel() { assert(geomModel_); return *geomModel_; }
+      GeomModel &       geomModel() { loadDeferredGeometry(); assert(geomModel_); return *geomModel_; }
 
       /// Set Pinocchio data corresponding to model
       void data( DataPtr_t dataPtr ) { data_ = dataPtr; resizeState(); }
@@ -138,16 +142,54 @@ namespace hpp {
       /// Set Pinocchio geomData corresponding to model
       void geomData( GeomDataPtr_t geomDataPtr ) { geomData_ = geomDataPtr; resizeState(); }
       /// Access to Pinocchio geomData/
-      GeomDataConstPtr_t       geomDataPtr() const { return geomData_; }
+      GeomDataConstPtr_t       geomDataPtr() const { loadDeferredGeometry(); return geomData_; }
       /// Access to Pinocchio geomData/
-      GeomDataPtr_t            geomDataPtr()       { return geomData_; }
+      GeomDataPtr_t            geomDataPtr()       { loadDeferredGeometry(); return geomData_; }
       /// Access to Pinocchio geomData/
-      const GeomData& geomData() const    { assert(geomData_); return *geomData_; }
+      const GeomData& geomData() const    { loadDeferredGeometry(); assert(geomData_); return *geomData_; }
       /// Access to Pinocchio geomData/
-      GeomData&       geomData()          { assert(geomData_); return *geomData_; }
+      GeomData&       geomData()          { loadDeferredGeometry(); assert(geomData_); return *geomData_; }
       /// Create Pinocchio geomData from model.
       void createGeomData();
 
+      /// Function that adds geometry objects to a geometry model
+      typedef boost::function <void (GeomModel&)> GeometryLoader_t;
+
+      /// Defer the loading of geometries
+      ///
+      /// The loader is called with an empty geometry model, which is then
+      /// appended to the geometry model of the device, and the geometry
+      /// data is created. This happens at the first access to the geometry
+      /// model or data, so that the kinematic model can be used without
+      /// loading the geometries.
+      /// \param background if true, the loader is called right away in
+      ///        a separate thread, and the first access to the geometries
+      ///        waits for it.
+      /// \note the loader must not access the device, as it may be called
+      ///       from another thread.
+      void deferGeometry (const GeometryLoader_t& loader,
+                          bool background = false);
+
+      /// Whether some geometries have not been loaded yet
+      bool hasDeferredGeometry () const
+      {
+        return !geometryLoaded_.load (boost::memory_order_acquire);
+      }
+
+      /// Load the geometries deferred by deferGeometry
+      ///
+      /// This is called by the accessors to the geometry model and data.
+      /// It can be called by several threads: one of them loads the
+      /// geometries while the others wait for it.
+      /// \throw the exception thrown by a loader. The geometries of the
+      ///        other loaders are added nevertheless.
+      void loadDeferredGeometry () const
+      {
+        // Acquire the geometries written by the thread that loaded them.
+        if (!geometryLoaded_.load (boost::memory_order_acquire))
+          appendDeferredGeometry();
+      }
+
       /// \}
       // -----------------------------------------------------------------------
       /// \name Joints
@@ -197,8 +239,21 @@ namespace hpp {
       size_type numberDof () const;
 
       /// Returns a LiegroupSpace representing the configuration space.
+      /// \note the instance is canonical. Use LiegroupSpace::createCopy to
+      ///       get an instance that can be modified.
       const LiegroupSpacePtr_t& configSpace () const { return configSpace_; }
 
+      /// Map from configuration to velocity indexes
+      /// \return a vector of size configSize(). Element \c i is the index of
+      ///         the velocity of the degree of freedom parameterized by
+      ///         coordinate \c i of configurations. For joints with more
+      ///         coordinates than degrees of freedom, the extra coordinates
+      ///         are mapped to the last degree of freedom of the joint.
+      const std::vector<size_type>& configToVelocityIndex () const
+      {
+        return configToVelocityIndex_;
+      }
+
       /// \}
       // -----------------------------------------------------------------------
       /// \name Extra configuration space
@@ -333,6 +388,25 @@ namespace hpp {
 
       /// Get result of distance computations
       const DistanceResults_t& distanceResults () const;
+
+      /// Use convex proxies in collisionTest
+      ///
+      /// Each mesh is approximated by an oriented bounding box, computed
+      /// from the principal axes of its vertices. The proxies of a pair are
+      /// tested first and the meshes only if the proxies collide.
+      /// Primitives are their own proxy.
+      void useCollisionProxies (bool use) { useCollisionProxies_ = use; }
+
+      /// Whether collisionTest uses convex proxies
+      bool useCollisionProxies () const { return useCollisionProxies_; }
+
+      /// Lower bound of the distance between the objects of a collision pair
+      ///
+      /// This is the distance between the convex proxies of the objects, or
+      /// 0 if they collide.
+      /// \param pairIndex index in GeomModel::collisionPairs
+      /// \warning Users should call computeForwardKinematics first.
+      value_type distanceLowerBound (const std::size_t& pairIndex);
       /// \}
       // -----------------------------------------------------------------------
       /// \name Forward kinematics
@@ -392,12 +466,36 @@ namespace hpp {
       /// Resize configuration when changing data or extra-config.
       void resizeState ();
 
+      /// Call or wait for the deferred loaders and add their geometries.
+      void appendDeferredGeometry () const;
+
+      struct DeferredGeometry;
+      typedef boost::shared_ptr<DeferredGeometry> DeferredGeometryPtr_t;
+      struct LoadingGuard;
+
+      struct CollisionProxies;
+      /// Build the convex proxies if needed.
+      const CollisionProxies& collisionProxies ();
+
     protected:
       // Pinocchio objects
       ModelPtr_t model_; 
       DataPtr_t data_;
       GeomModelPtr_t geomModel_;
       GeomDataPtr_t geomData_;
+      /// Geometries not loaded yet, in the order of deferGeometry calls.
+      mutable std::vector<DeferredGeometryPtr_t> deferredGeometry_;
+      /// Protects deferredGeometry_ and the loading of the geometries.
+      mutable boost::recursive_mutex deferredGeometryMutex_;
+      /// Whether the current owner of deferredGeometryMutex_ is loading
+      /// the geometries.
+      mutable bool loadingDeferredGeometry_;
+      /// Whether all deferred geometries are loaded. Set with release
+      /// semantics once the geometry model and data are complete.
+      mutable boost::atomic<bool> geometryLoaded_;
+      /// Convex proxies of the geometries, built on demand.
+      boost::shared_ptr<const CollisionProxies> collisionProxies_;
+      bool useCollisionProxies_;
 
       inline void invalidate () { upToDate_ = false; frameUpToDate_ = false; geomUpToDate_ = false; }
 
@@ -414,6 +512,7 @@ namespace hpp {
       // Grippers
       Grippers_t grippers_;
       LiegroupSpacePtr_t configSpace_;
+      std::vector<size_type> configToVelocityIndex_;
       // Extra configuration space
       ExtraConfigSpace extraConfigSpace_;
       DeviceWkPtr_t weakPtr_;
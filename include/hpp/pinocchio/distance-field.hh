@@ -0,0 +1,141 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_PINOCCHIO_DISTANCE_FIELD_HH
+# define HPP_PINOCCHIO_DISTANCE_FIELD_HH
+
+# include <string>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Signed distance field of the static obstacles of a device
+    ///
+    /// The obstacles are the geometry objects attached to the universe
+    /// joint, at their current placement. They are sampled on a regular
+    /// grid of voxels: a voxel is occupied if it intersects an obstacle.
+    /// The distance from the center of each voxel to the nearest occupied
+    /// (resp. free) voxel is computed by an exact Euclidean distance
+    /// transform. The value of a voxel is this distance, minus half a
+    /// voxel, positive in free voxels and negative in occupied ones.
+    ///
+    /// Lookups interpolate the values of the 8 surrounding voxels, so the
+    /// accuracy is about the resolution of the grid. By default, only the
+    /// voxels that intersect the surface of a mesh are occupied. Closed
+    /// meshes can be filled on demand: the voxels they enclose, which
+    /// cannot be reached from outside of their bounding box without
+    /// crossing them, are then occupied as well.
+    ///
+    /// The field is built once and does not follow the obstacles if they
+    /// are moved afterwards. It can be saved to and loaded from a file,
+    /// with a key of the obstacles it was built from. Method matches tells
+    /// whether a loaded field is still valid.
+    class HPP_PINOCCHIO_DLLAPI DistanceField
+    {
+      public:
+        typedef Eigen::Matrix<size_type, 3, 1> Dimensions_t;
+
+        /// Maximal number of voxels of a field, 2^27. The values of such a
+        /// field use 1 GB, and three times more during its construction.
+        static const size_type MaxVoxels;
+
+        /// Build the distance field of the obstacles of a device.
+        /// \param resolution size of the voxels,
+        /// \param margin distance between the bounding box of the
+        ///        obstacles and the boundary of the grid,
+        /// \param fillMeshes whether the interior of the meshes is occupied.
+        ///        Only use it if all the meshes are closed: the interior of
+        ///        an open mesh is its whole bounding box.
+        /// \throw std::invalid_argument if the device has no obstacle or if
+        ///        the grid would have more than MaxVoxels voxels.
+        static DistanceFieldPtr_t create (const DevicePtr_t& device,
+                                          const value_type& resolution,
+                                          const value_type& margin,
+                                          const bool& fillMeshes = false);
+
+        /// Load a distance field saved with method save.
+        ///
+        /// The field may have been built from other obstacles. Check it
+        /// with method matches.
+        /// \throw std::invalid_argument if the file cannot be read, is not
+        ///        a distance field or has more than MaxVoxels voxels.
+        static DistanceFieldPtr_t load (const std::string& filename);
+
+        /// Save the distance field to a binary file.
+        /// \throw std::invalid_argument if the file cannot be written.
+        void save (const std::string& filename) const;
+
+        /// Whether the field was built from the current obstacles of a
+        /// device: same names, placements and shapes, in the same order.
+        /// \note meshesFilled tells how the meshes were voxelized.
+        bool matches (const DevicePtr_t& device) const;
+
+        /// Signed distance of a point to the obstacles
+        ///
+        /// Points outside of the grid get the value at the nearest point of
+        /// the grid plus the distance to this point.
+        value_type distance (const vector3_t& point) const;
+
+        /// Signed distance of a point to the obstacles and its gradient
+        /// \retval gradient the gradient of the interpolated distance.
+        value_type distance (const vector3_t& point, vector3_t& gradient) const;
+
+        /// Signed distances of spheres to the obstacles
+        ///
+        /// \retval distances the distance of the center of each sphere minus
+        ///         its radius.
+        /// \note SphereApproximation also covers the obstacles. Their
+        ///       spheres get a negative distance.
+        void distances (const SphereApproximation& spheres,
+                        vector_t& distances) const;
+
+        /// Position of the center of the first voxel
+        const vector3_t& origin () const { return origin_; }
+        /// Size of the voxels
+        const value_type& resolution () const { return resolution_; }
+        /// Number of voxels along each axis
+        const Dimensions_t& dimensions () const { return dimensions_; }
+        /// Values of the voxels, x varying fastest.
+        const vector_t& values () const { return values_; }
+        /// Whether the interior of the meshes is occupied
+        bool meshesFilled () const { return meshesFilled_; }
+
+      protected:
+        DistanceField ();
+
+      private:
+        void build (const GeomModel& geomModel, const value_type& margin);
+
+        size_type index (const size_type& i, const size_type& j,
+                         const size_type& k) const
+        {
+          return i + dimensions_[0] * (j + dimensions_[1] * k);
+        }
+
+        vector3_t origin_;
+        value_type resolution_;
+        Dimensions_t dimensions_;
+        vector_t values_;
+        /// Hash of the obstacles the field was built from
+        std::size_t key_;
+        bool meshesFilled_;
+    }; // class DistanceField
+  }  // namespace pinocchio
+}  // namespace hpp
+#endif // HPP_PINOCCHIO_DISTANCE_FIELD_HH
@@ -41,7 +41,14 @@ namespace hpp {
     HPP_PREDEF_CLASS (JointConfiguration);
     HPP_PREDEF_CLASS (Gripper);
     HPP_PREDEF_CLASS (CenterOfMassComputation);
+    HPP_PREDEF_CLASS (MultiCenterOfMassComputation);
+    HPP_PREDEF_CLASS (SphereApproximation);
+    HPP_PREDEF_CLASS (DistanceField);
+    HPP_PREDEF_CLASS (NearestNeighbor);
+    HPP_PREDEF_CLASS (ConfigurationMetric);
+    HPP_PREDEF_CLASS (ConfigurationSampler);
     class Frame;
+    class BlockDiagonalMatrix;
 
     enum Request_t {COLLISION, DISTANCE};
     enum InOutType { INNER, OUTER };
@@ -68,6 +75,7 @@ namespace hpp {
     typedef Eigen::Ref <const vector_t> vectorIn_t;
     typedef Eigen::Ref <vector_t> vectorOut_t;
     typedef Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic> matrix_t;
+    typedef Eigen::Ref <const matrix_t> matrixIn_t;
     typedef Eigen::Ref <matrix_t> matrixOut_t;
     typedef matrix_t::Index size_type;
     typedef Eigen::Matrix<value_type, 3, 3> matrix3_t;
@@ -94,6 +102,13 @@ namespace hpp {
     typedef std::vector <fcl::DistanceResult> DistanceResults_t;
     typedef boost::shared_ptr <HumanoidRobot> HumanoidRobotPtr_t;
     typedef boost::shared_ptr <CenterOfMassComputation> CenterOfMassComputationPtr_t;
+    typedef boost::shared_ptr <MultiCenterOfMassComputation>
+      MultiCenterOfMassComputationPtr_t;
+    typedef boost::shared_ptr <SphereApproximation> SphereApproximationPtr_t;
+    typedef boost::shared_ptr <DistanceField> DistanceFieldPtr_t;
+    typedef boost::shared_ptr <NearestNeighbor> NearestNeighborPtr_t;
+    typedef boost::shared_ptr <ConfigurationMetric> ConfigurationMetricPtr_t;
+    typedef boost::shared_ptr <ConfigurationSampler> ConfigurationSamplerPtr_t;
     typedef boost::shared_ptr<Joint> JointPtr_t;
     typedef boost::shared_ptr<const Joint> JointConstPtr_t;
     typedef boost::shared_ptr <Gripper> GripperPtr_t;
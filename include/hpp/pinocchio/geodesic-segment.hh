@@ -0,0 +1,104 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_GEODESIC_SEGMENT_HH
+# define HPP_PINOCCHIO_GEODESIC_SEGMENT_HH
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+# include <hpp/pinocchio/liegroup.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Geodesic between two configurations
+    ///
+    /// The tangent vector \f$\mathbf{v} = \mathbf{q}_1 \ominus \mathbf{q}_0\f$
+    /// is computed once at construction. The configuration at parameter
+    /// \f$u\f$ is then \f$\mathbf{q}_0 \oplus u\mathbf{v}\f$, which is the
+    /// same as interpolate<LieGroup> (robot, q0, q1, u, result) but does not
+    /// compute the difference at each evaluation.
+    ///
+    /// \tparam LieGroup the Lie group map, as for interpolate and difference.
+    template <typename LieGroup>
+    class HPP_PINOCCHIO_DLLAPI GeodesicSegmentTpl
+    {
+      public:
+        /// Constructor
+        /// \param robot robot that describes the kinematic chain
+        /// \param q0, q1 the configurations at u=0 and u=1
+        GeodesicSegmentTpl (const DevicePtr_t& robot,
+                            ConfigurationIn_t q0, ConfigurationIn_t q1);
+
+        /// Set the end configurations
+        void reset (ConfigurationIn_t q0, ConfigurationIn_t q1);
+
+        /// Configuration at parameter u
+        /// \param u in [0,1], q0 for u=0, q1 for u=1
+        /// \retval result the configuration
+        /// \note for u=0 and u=1, the end configurations are copied, so
+        ///       that the result is exact.
+        /// \note allocates a vector of size robot->numberDof (). Use the
+        ///       overload with a workspace to evaluate many configurations.
+        void evaluate (const value_type& u, ConfigurationOut_t result) const;
+
+        /// Configuration at parameter u, without allocation
+        /// \param u in [0,1], q0 for u=0, q1 for u=1
+        /// \retval result the configuration
+        /// \param velocity a workspace of size robot->numberDof ().
+        ///
+        /// Calls with different workspaces can run concurrently.
+        void evaluate (const value_type& u, ConfigurationOut_t result,
+                       vectorOut_t velocity) const;
+
+        /// Configurations at several parameters
+        /// \param us the parameters,
+        /// \retval result a matrix of robot->configSize() rows and
+        ///         us.size() columns. Column i is the configuration at us[i].
+        void evaluate (vectorIn_t us, matrixOut_t result) const;
+
+        /// Configuration at u=0
+        const Configuration_t& initial () const
+        {
+          return q0_;
+        }
+
+        /// Configuration at u=1
+        const Configuration_t& end () const
+        {
+          return q1_;
+        }
+
+        /// Tangent vector \f$\mathbf{q}_1 \ominus \mathbf{q}_0\f$
+        const vector_t& tangent () const
+        {
+          return v_;
+        }
+
+      private:
+        DevicePtr_t robot_;
+        Configuration_t q0_, q1_;
+        vector_t v_;
+    }; // class GeodesicSegmentTpl
+
+    typedef GeodesicSegmentTpl<LieGroupTpl> GeodesicSegment;
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_GEODESIC_SEGMENT_HH
@@ -197,6 +197,8 @@ namespace hpp {
       virtual std::ostream& display (std::ostream& os) const;
 
       /// Get configuration space of joint
+      /// \note the instance is canonical. Use LiegroupSpace::createCopy to
+      ///       get an instance that can be modified.
       LiegroupSpacePtr_t configurationSpace () const;
 
       /// \name Pinocchio API
@@ -0,0 +1,230 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_LIEGROUP_ELEMENT_POOL_HH
+# define HPP_PINOCCHIO_LIEGROUP_ELEMENT_POOL_HH
+
+# include <boost/mpl/if.hpp>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/liegroup-element.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Non-owning view on an element of a Lie group
+    ///
+    /// A view is a pointer to the vector representation and a raw pointer
+    /// to the Lie group. It does not allocate memory nor change reference
+    /// counts. The memory and the Lie group must outlive the view.
+    ///
+    /// \tparam IsConst whether the vector representation is read-only.
+    template <bool IsConst>
+    class LiegroupElementViewTpl
+    {
+      public:
+        typedef typename boost::mpl::if_c <IsConst, const value_type,
+                                           value_type>::type Scalar_t;
+        typedef Eigen::Map <typename boost::mpl::if_c <IsConst, const vector_t,
+                                                       vector_t>::type> Map_t;
+
+        /// Constructor
+        /// \param data vector representation, of size space->nq (),
+        /// \param space the Lie group.
+        LiegroupElementViewTpl (Scalar_t* data, const LiegroupSpace* space)
+          : data_ (data), space_ (space) {}
+
+        /// Conversion of a modifiable view to a read-only view
+        LiegroupElementViewTpl (const LiegroupElementViewTpl <false>& other)
+          : data_ (other.data ()), space_ (other.space ()) {}
+
+        /// Vector representation
+        Map_t vector () const
+        {
+          return Map_t (data_, space_->nq ());
+        }
+
+        /// Pointer to the vector representation
+        Scalar_t* data () const
+        {
+          return data_;
+        }
+
+        /// The Lie group
+        const LiegroupSpace* space () const
+        {
+          return space_;
+        }
+
+      private:
+        Scalar_t* data_;
+        const LiegroupSpace* space_;
+    }; // class LiegroupElementViewTpl
+
+    typedef LiegroupElementViewTpl <true > LiegroupConstElementView;
+    typedef LiegroupElementViewTpl <false> LiegroupElementView;
+
+    /// Integration of a velocity vector from a view
+    /// \retval result may be a view on the same memory as e.
+    HPP_PINOCCHIO_DLLAPI void integrate (LiegroupConstElementView e,
+        vectorIn_t v, LiegroupElementView result);
+
+    /// Difference between two views
+    /// \retval result the velocity that integrated from e2 yields e1.
+    HPP_PINOCCHIO_DLLAPI void difference (LiegroupConstElementView e1,
+        LiegroupConstElementView e2, vectorOut_t result);
+
+    /// Contiguous storage of elements of a Lie group
+    ///
+    /// Elements are the columns of a matrix, so that the storage of n
+    /// elements costs one allocation and the Lie group is shared by all
+    /// elements. Elements are accessed through views, and operations can be
+    /// applied to all elements at once.
+    ///
+    /// \warning like for std::vector, increasing the size beyond the
+    ///          capacity invalidates the views.
+    class HPP_PINOCCHIO_DLLAPI LiegroupElementPool
+    {
+      public:
+        typedef Eigen::Block <matrix_t, Eigen::Dynamic, Eigen::Dynamic, true>
+          Block_t;
+        typedef Eigen::Block <const matrix_t, Eigen::Dynamic, Eigen::Dynamic,
+                              true> ConstBlock_t;
+
+        /// Constructor
+        /// \param space the Lie group of the elements,
+        /// \param capacity number of elements for which memory is allocated.
+        explicit LiegroupElementPool (const LiegroupSpacePtr_t& space,
+                                      const size_type& capacity = 0);
+
+        /// The Lie group of the elements
+        const LiegroupSpacePtr_t& space () const
+        {
+          return space_;
+        }
+
+        /// Number of elements
+        size_type size () const
+        {
+          return size_;
+        }
+
+        /// Number of elements that can be stored without allocation
+        size_type capacity () const
+        {
+          return data_.cols ();
+        }
+
+        /// Allocate memory for n elements
+        void reserve (const size_type& n);
+
+        /// Set the number of elements
+        /// New elements are set to the neutral element.
+        void resize (const size_type& n);
+
+        /// Remove all elements. Memory is kept.
+        void clear ()
+        {
+          size_ = 0;
+        }
+
+        /// Append an element
+        /// \param q vector representation of the element.
+        /// \return the index of the new element.
+        size_type push_back (vectorIn_t q);
+
+        /// Append an element
+        /// \return the index of the new element.
+        template <typename vector_type>
+        size_type push_back (const LiegroupElementBase <vector_type>& e)
+        {
+          assert (*e.space () == *space_);
+          return push_back (e.vector ());
+        }
+
+        /// View on element i
+        LiegroupElementView operator[] (const size_type& i)
+        {
+          assert (i < size_);
+          return LiegroupElementView (data_.col (i).data (), space_.get ());
+        }
+
+        /// Read-only view on element i
+        LiegroupConstElementView operator[] (const size_type& i) const
+        {
+          assert (i < size_);
+          return LiegroupConstElementView (data_.col (i).data (),
+                                           space_.get ());
+        }
+
+        /// Copy of element i
+        LiegroupElement element (const size_type& i) const
+        {
+          assert (i < size_);
+          return LiegroupElement (data_.col (i), space_);
+        }
+
+        /// Elements as the columns of a matrix
+        Block_t matrix ()
+        {
+          return data_.leftCols (size_);
+        }
+
+        /// Elements as the columns of a matrix
+        ConstBlock_t matrix () const
+        {
+          return data_.leftCols (size_);
+        }
+
+        /// \name Operations on all elements
+        /// \{
+
+        /// Compute \f$ e_i \leftarrow e_i + v_i \f$
+        /// \param velocities a matrix of space ()->nv () rows and size ()
+        ///        columns.
+        void integrate (matrixIn_t velocities);
+
+        /// Compute \f$ v_i = e_i - q \f$
+        /// \retval result a matrix of space ()->nv () rows and size ()
+        ///         columns.
+        void difference (vectorIn_t q, matrixOut_t result) const;
+
+        /// Compute \f$ v_i = e_i - f_i \f$ where f is another pool of the
+        /// same size
+        /// \retval result a matrix of space ()->nv () rows and size ()
+        ///         columns.
+        void difference (const LiegroupElementPool& other,
+                         matrixOut_t result) const;
+
+        /// Compute the log of all elements
+        /// \retval result a matrix of space ()->nv () rows and size ()
+        ///         columns.
+        void log (matrixOut_t result) const;
+        /// \}
+
+      private:
+        LiegroupSpacePtr_t space_;
+        /// Vector representation of the elements, as columns
+        matrix_t data_;
+        size_type size_;
+    }; // class LiegroupElementPool
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_LIEGROUP_ELEMENT_POOL_HH
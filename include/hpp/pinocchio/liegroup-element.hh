@@ -164,12 +164,39 @@ namespace hpp {
     /// of a constant velocity during unit time by an addition
     template <typename vector_type1, typename vector_type2>
     vector_t operator- (const LiegroupElementBase<vector_type1>& e1, const LiegroupElementBase<vector_type2>& e2);
+
+    /// Integration of a velocity vector from a configuration without
+    /// memory allocation
+    ///
+    /// \param e element of the Lie group,
+    /// \param v element of the tangent space of the Lie group,
+    /// \retval result the element of the Lie group resulting from the
+    ///         integration. It may refer to the same vector as e.
+    template <typename vector_type>
+    void integrate (const LiegroupElementBase<vector_type>& e, vectorIn_t v,
+                    LiegroupElementRef result);
+
+    /// Difference between two configurations without memory allocation
+    ///
+    /// \param e1, e2 elements of the Lie group,
+    /// \retval result the velocity that integrated from e2 yields e1, of
+    ///         size e1.space ()->nv ().
+    template <typename vector_type1, typename vector_type2>
+    void difference (const LiegroupElementBase<vector_type1>& e1,
+                     const LiegroupElementBase<vector_type2>& e2,
+                     vectorOut_t result);
     /// \}
 
     /// Compute the log as a tangent vector of a Lie group element
     template <typename vector_type>
     vector_t log (const LiegroupElementBase<vector_type>& lge);
 
+    /// Compute the log as a tangent vector of a Lie group element without
+    /// memory allocation
+    /// \retval result the log, of size lge.space ()->nv ().
+    template <typename vector_type>
+    void log (const LiegroupElementBase<vector_type>& lge, vectorOut_t result);
+
     template <typename vector_type>
     inline std::ostream& operator<< (std::ostream& os, const LiegroupElementBase<vector_type>& e)
     {
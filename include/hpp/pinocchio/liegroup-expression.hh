@@ -0,0 +1,381 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_LIEGROUP_EXPRESSION_HH
+# define HPP_PINOCCHIO_LIEGROUP_EXPRESSION_HH
+
+# include <algorithm>
+
+# include <hpp/pinocchio/liegroup-element.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// Lazy evaluation of chains of Lie group operations
+    ///
+    /// Operators + and - on LiegroupElement compute their result
+    /// immediately, so that a chain such as <tt>(q + v1) + v2</tt> creates
+    /// intermediate elements. Wrapping the first element with function lazy
+    /// builds an expression instead:
+    /// \code
+    /// LiegroupElement q2 (q.space ());
+    /// evaluate (lazy (q) + v1 + v2, LiegroupElementRef (q2.vector (), q2.space ()));
+    /// // Interpolation between q0 and q1
+    /// evaluate (lazy (q0) + (lazy (q1) - q0) * u, result);
+    /// \endcode
+    ///
+    /// evaluate traverses the plan of operations of the Lie group once. Each
+    /// elementary Lie group, or chunk of vector space, is evaluated for the
+    /// whole expression in fixed size buffers. Neither building nor
+    /// evaluating an expression allocates memory. The result may refer to
+    /// the vector of an element of the expression.
+    ///
+    /// \warning expressions refer to the elements and vectors they are
+    ///          built from. They must be evaluated in the full-expression
+    ///          that creates them and never be stored, since the elements
+    ///          and vectors may be temporaries.
+    namespace liegroupExpression {
+      /// Maximal size of the chunks of the vector representation
+      enum { MaxChunkSize = 8 };
+      typedef Eigen::Matrix <value_type, Eigen::Dynamic, 1, 0, MaxChunkSize, 1>
+        ChunkVector_t;
+
+      /// Part of the vector representation that is evaluated at once
+      struct Chunk {
+        LiegroupSpace::Operation::Kind_t kind;
+        size_type iq, iv, nq, nv;
+      };
+
+      template <typename LgT>
+      inline void integrate (ChunkVector_t& q, const ChunkVector_t& v)
+      {
+        LgT ().integrate_impl (q.head <LgT::NQ> (), v.head <LgT::NV> (),
+                               q.head <LgT::NQ> ());
+      }
+
+      template <typename LgT>
+      inline void difference (const ChunkVector_t& q0, const ChunkVector_t& q1,
+                              ChunkVector_t& d)
+      {
+        LgT ().difference_impl (q0.head <LgT::NQ> (), q1.head <LgT::NQ> (),
+                                d.head <LgT::NV> ());
+      }
+
+      /// Compute \f$ q \leftarrow q \oplus v \f$ on a chunk
+      inline void integrate (const Chunk& c, ChunkVector_t& q,
+                             const ChunkVector_t& v)
+      {
+        typedef LiegroupSpace::Operation Operation;
+        switch (c.kind) {
+          case Operation::VECTOR_SPACE: q += v; break;
+          case Operation::SO2:
+            integrate <liegroup::SpecialOrthogonalOperation<2> > (q, v); break;
+          case Operation::SO3:
+            integrate <liegroup::SpecialOrthogonalOperation<3> > (q, v); break;
+          case Operation::SE2:
+            integrate <se3::SpecialEuclideanOperation<2> > (q, v); break;
+          case Operation::SE3:
+            integrate <se3::SpecialEuclideanOperation<3> > (q, v); break;
+        }
+      }
+
+      /// Compute \f$ d = q_1 \ominus q_0 \f$ on a chunk
+      inline void difference (const Chunk& c, const ChunkVector_t& q0,
+                              const ChunkVector_t& q1, ChunkVector_t& d)
+      {
+        typedef LiegroupSpace::Operation Operation;
+        d.resize (c.nv);
+        switch (c.kind) {
+          case Operation::VECTOR_SPACE: d = q1 - q0; break;
+          case Operation::SO2:
+            difference <liegroup::SpecialOrthogonalOperation<2> > (q0, q1, d);
+            break;
+          case Operation::SO3:
+            difference <liegroup::SpecialOrthogonalOperation<3> > (q0, q1, d);
+            break;
+          case Operation::SE2:
+            difference <se3::SpecialEuclideanOperation<2> > (q0, q1, d);
+            break;
+          case Operation::SE3:
+            difference <se3::SpecialEuclideanOperation<3> > (q0, q1, d);
+            break;
+        }
+      }
+
+      /// Call functor f on each chunk of a Lie group
+      template <typename Functor>
+      inline void forEachChunk (const LiegroupSpace& space, Functor& f)
+      {
+        typedef LiegroupSpace::Operation Operation;
+        const LiegroupSpace::Operations_t& ops (space.operations ());
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          Chunk c; c.kind = op.kind;
+          size_type nq (0), nv (0);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE: nq = nv = MaxChunkSize; break;
+            case Operation::SO2: nq = 2; nv = 1; break;
+            case Operation::SO3: nq = 4; nv = 3; break;
+            case Operation::SE2: nq = 4; nv = 3; break;
+            case Operation::SE3: nq = 7; nv = 6; break;
+          }
+          for (c.iq = op.iq, c.iv = op.iv; c.iq < op.iq + op.nq;
+               c.iq += c.nq, c.iv += c.nv) {
+            c.nq = std::min (nq, op.iq + op.nq - c.iq);
+            c.nv = std::min (nv, op.iv + op.nv - c.iv);
+            f (c);
+          }
+        }
+      }
+
+      /// Base class of expressions that are elements of a Lie group
+      template <typename Derived> struct ElementExpression
+      {
+        const Derived& derived () const
+        {
+          return static_cast <const Derived&> (*this);
+        }
+      };
+
+      /// Base class of expressions that are tangent vectors
+      template <typename Derived> struct TangentExpression
+      {
+        const Derived& derived () const
+        {
+          return static_cast <const Derived&> (*this);
+        }
+      };
+
+      /// Element of a Lie group
+      ///
+      /// Refers to the element, which must outlive the expression.
+      template <typename vector_type> struct Element :
+        ElementExpression <Element <vector_type> >
+      {
+        Element (const LiegroupElementBase <vector_type>& e) : e_ (e) {}
+        const LiegroupSpacePtr_t& space () const
+        {
+          return e_.space ();
+        }
+        void evaluate (const Chunk& c, ChunkVector_t& q) const
+        {
+          q = e_.vector ().segment (c.iq, c.nq);
+        }
+        const LiegroupElementBase <vector_type>& e_;
+      };
+
+      /// Tangent vector
+      ///
+      /// The vector is stored as Eigen nests it in its own expressions:
+      /// plain vectors by reference, expressions such as
+      /// <tt>v * alpha</tt> by value, since they are temporaries.
+      template <typename V> struct Tangent : TangentExpression <Tangent <V> >
+      {
+        Tangent (const Eigen::MatrixBase <V>& v) : v_ (v.derived ()) {}
+        void evaluate (const Chunk& c, ChunkVector_t& v) const
+        {
+          v = v_.segment (c.iv, c.nv);
+        }
+        typename V::Nested v_;
+      };
+
+      /// Product of a tangent vector by a scalar
+      template <typename T> struct Scaled : TangentExpression <Scaled <T> >
+      {
+        Scaled (const T& v, const value_type& s) : v_ (v), s_ (s) {}
+        void evaluate (const Chunk& c, ChunkVector_t& v) const
+        {
+          v_.evaluate (c, v);
+          v *= s_;
+        }
+        T v_;
+        value_type s_;
+      };
+
+      /// \f$ q \oplus v \f$
+      template <typename E, typename T> struct Integration :
+        ElementExpression <Integration <E, T> >
+      {
+        Integration (const E& q, const T& v) : q_ (q), v_ (v) {}
+        const LiegroupSpacePtr_t& space () const
+        {
+          return q_.space ();
+        }
+        void evaluate (const Chunk& c, ChunkVector_t& q) const
+        {
+          ChunkVector_t v;
+          q_.evaluate (c, q);
+          v_.evaluate (c, v);
+          liegroupExpression::integrate (c, q, v);
+        }
+        E q_;
+        T v_;
+      };
+
+      /// \f$ q_1 \ominus q_0 \f$
+      template <typename E1, typename E0> struct Difference :
+        TangentExpression <Difference <E1, E0> >
+      {
+        Difference (const E1& q1, const E0& q0) : q1_ (q1), q0_ (q0) {}
+        void evaluate (const Chunk& c, ChunkVector_t& v) const
+        {
+          ChunkVector_t q0, q1;
+          q0_.evaluate (c, q0);
+          q1_.evaluate (c, q1);
+          liegroupExpression::difference (c, q0, q1, v);
+        }
+        E1 q1_;
+        E0 q0_;
+      };
+
+      template <typename E> struct ElementEvaluator
+      {
+        ElementEvaluator (const E& e, vectorOut_t result)
+          : e_ (e), result_ (result) {}
+        void operator () (const Chunk& c)
+        {
+          e_.evaluate (c, q_);
+          result_.segment (c.iq, c.nq) = q_;
+        }
+        const E& e_;
+        vectorOut_t result_;
+        ChunkVector_t q_;
+      };
+
+      template <typename T> struct TangentEvaluator
+      {
+        TangentEvaluator (const T& t, vectorOut_t result)
+          : t_ (t), result_ (result) {}
+        void operator () (const Chunk& c)
+        {
+          t_.evaluate (c, v_);
+          result_.segment (c.iv, c.nv) = v_;
+        }
+        const T& t_;
+        vectorOut_t result_;
+        ChunkVector_t v_;
+      };
+    } // namespace liegroupExpression
+
+    /// Start an expression from an element
+    template <typename vector_type>
+    liegroupExpression::Element <vector_type> lazy
+    (const LiegroupElementBase <vector_type>& e)
+    {
+      return liegroupExpression::Element <vector_type> (e);
+    }
+
+    /// Integration of a tangent vector
+    template <typename E, typename V>
+    liegroupExpression::Integration <E, liegroupExpression::Tangent <V> >
+    operator+ (const liegroupExpression::ElementExpression <E>& q,
+               const Eigen::MatrixBase <V>& v)
+    {
+      return liegroupExpression::Integration
+        <E, liegroupExpression::Tangent <V> >
+        (q.derived (), liegroupExpression::Tangent <V> (v));
+    }
+
+    /// Integration of a tangent vector expression
+    template <typename E, typename T>
+    liegroupExpression::Integration <E, T>
+    operator+ (const liegroupExpression::ElementExpression <E>& q,
+               const liegroupExpression::TangentExpression <T>& v)
+    {
+      return liegroupExpression::Integration <E, T> (q.derived (),
+                                                     v.derived ());
+    }
+
+    /// Difference between two element expressions
+    template <typename E1, typename E0>
+    liegroupExpression::Difference <E1, E0>
+    operator- (const liegroupExpression::ElementExpression <E1>& q1,
+               const liegroupExpression::ElementExpression <E0>& q0)
+    {
+      return liegroupExpression::Difference <E1, E0> (q1.derived (),
+                                                      q0.derived ());
+    }
+
+    /// Difference between an element expression and an element
+    template <typename E1, typename vector_type>
+    liegroupExpression::Difference <E1, liegroupExpression::Element <vector_type> >
+    operator- (const liegroupExpression::ElementExpression <E1>& q1,
+               const LiegroupElementBase <vector_type>& q0)
+    {
+      return liegroupExpression::Difference
+        <E1, liegroupExpression::Element <vector_type> >
+        (q1.derived (), liegroupExpression::Element <vector_type> (q0));
+    }
+
+    /// Product of a tangent vector expression by a scalar
+    template <typename T>
+    liegroupExpression::Scaled <T>
+    operator* (const liegroupExpression::TangentExpression <T>& v,
+               const value_type& s)
+    {
+      return liegroupExpression::Scaled <T> (v.derived (), s);
+    }
+
+    /// Product of a tangent vector expression by a scalar
+    template <typename T>
+    liegroupExpression::Scaled <T>
+    operator* (const value_type& s,
+               const liegroupExpression::TangentExpression <T>& v)
+    {
+      return liegroupExpression::Scaled <T> (v.derived (), s);
+    }
+
+    /// Evaluate an element expression
+    /// \retval result an element of the same Lie group as the expression.
+    template <typename E>
+    void evaluate (const liegroupExpression::ElementExpression <E>& e,
+                   LiegroupElementRef result)
+    {
+      const LiegroupSpace& space (*e.derived ().space ());
+      assert (space == *result.space ());
+      liegroupExpression::ElementEvaluator <E> f (e.derived (),
+                                                  result.vector ());
+      liegroupExpression::forEachChunk (space, f);
+    }
+
+    /// Evaluate a tangent vector expression
+    /// \param space the Lie group of the elements of the expression,
+    /// \retval result a vector of size space.nv ().
+    template <typename T>
+    void evaluate (const LiegroupSpace& space,
+                   const liegroupExpression::TangentExpression <T>& v,
+                   vectorOut_t result)
+    {
+      assert (result.size () == space.nv ());
+      liegroupExpression::TangentEvaluator <T> f (v.derived (), result);
+      liegroupExpression::forEachChunk (space, f);
+    }
+
+    /// Evaluate an element expression in a new element
+    template <typename E>
+    LiegroupElement evaluate (const liegroupExpression::ElementExpression <E>& e)
+    {
+      LiegroupElement result (e.derived ().space ());
+      evaluate (e, LiegroupElementRef (result.vector (), result.space ()));
+      return result;
+    }
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_LIEGROUP_EXPRESSION_HH
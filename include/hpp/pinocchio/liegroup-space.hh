@@ -74,6 +74,33 @@ namespace hpp {
     {
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+      /// Elementary operation of the compiled plan of the Lie group
+      ///
+      /// The plan is a flat array of operations computed once from the
+      /// elementary Lie groups. Cartesian products are split, consecutive
+      /// vector spaces are merged into one operation and consecutive
+      /// identical Lie groups are gathered in one operation.
+      struct Operation {
+        enum Kind_t {
+          /// Vector space of any dimension
+          VECTOR_SPACE,
+          /// Consecutive \f$SO(2)\f$
+          SO2,
+          /// Consecutive \f$SO(3)\f$
+          SO3,
+          /// Consecutive \f$SE(2)\f$
+          SE2,
+          /// Consecutive \f$SE(3)\f$
+          SE3
+        };
+        Kind_t kind;
+        /// Position in the vector representation and in the tangent space
+        size_type iq, iv;
+        /// Total size in the vector representation and in the tangent space
+        size_type nq, nv;
+      };
+      typedef std::vector <Operation> Operations_t;
       /// \name Elementary Lie groups
       /// \{
 
@@ -98,6 +125,38 @@ namespace hpp {
       static LiegroupSpacePtr_t empty ();
       /// \}
 
+      /// \name Canonical instances
+      /// \{
+
+      /// Return the canonical instance of a Lie group
+      ///
+      /// Canonical instances are stored in a global registry that contains
+      /// at most one instance per Lie group. Two canonical instances are
+      /// thus equal if and only if they are the same object.
+      /// If the registry contains no instance equal to space, a copy of
+      /// space is registered. space itself is never modified.
+      ///
+      /// The elementary Lie groups returned by Rn, R1, R2, R3, SE2, SE3,
+      /// R2xSO2, R3xSO3 and empty are new instances that can be modified.
+      /// \warning canonical instances cannot be modified. Use createCopy to
+      ///          get an instance that can be modified.
+      static LiegroupSpacePtr_t canonical (const LiegroupSpacePtr_t& space);
+
+      /// Whether this instance is canonical
+      bool isCanonical () const
+      {
+        return canonical_;
+      }
+
+      /// Hash of the structure of the Lie group
+      ///
+      /// Equal Lie groups have the same hash.
+      std::size_t hash () const
+      {
+        return hash_;
+      }
+      /// \}
+
       /// Create instance of vector space of given size
       static LiegroupSpacePtr_t create (const size_type& size)
       {
@@ -126,6 +185,11 @@ namespace hpp {
         return shPtr;
       }
 
+      /// Destructor
+      ///
+      /// Canonical instances are removed from the registry.
+      ~LiegroupSpace ();
+
       /// Dimension of the vector representation
       size_type nq () const
       {
@@ -153,6 +217,12 @@ namespace hpp {
         return liegroupTypes_;
       }
 
+      /// Get the compiled plan of operations
+      const Operations_t& operations () const
+      {
+        return operations_;
+      }
+
       /// Return the neutral element as a vector
       LiegroupElement neutral () const;
 
@@ -178,14 +248,45 @@ namespace hpp {
       template <bool ApplyOnTheLeft>
       void Jdifference (vectorIn_t q0, vectorIn_t q1, matrixOut_t J0, matrixOut_t J1) const;
 
+      /// Compute the Jacobian of the integration operation as a block
+      /// diagonal matrix.
+      /// Given \f$ y = x + v \f$,
+      ///
+      /// \param[in] v the tangent vector,
+      /// \param[out] J the Jacobian of y with respect to x.
+      /// \note J is resized to nv() and its memory is reused across calls.
+      void Jintegrate (vectorIn_t v, BlockDiagonalMatrix& J) const;
+
+      /// Compute the Jacobians of the difference operation as block
+      /// diagonal matrices.
+      /// Given \f$ v = q1 - q0 \f$,
+      ///
+      /// \param[in] q0,q1
+      /// \param[out] J0 the Jacobian of v with respect to q0.
+      /// \param[out] J1 the Jacobian of v with respect to q1.
+      /// \note J0 and J1 are resized to nv() and their memory is reused
+      ///       across calls.
+      void Jdifference (vectorIn_t q0, vectorIn_t q1,
+                        BlockDiagonalMatrix& J0,
+                        BlockDiagonalMatrix& J1) const;
+
       /// Return name of Lie group
       std::string name () const;
 
+      /// Merge consecutive vector spaces
+      /// \throw std::logic_error if the instance is canonical.
       void mergeVectorSpaces ();
 
+      /// Comparison
+      ///
+      /// Canonical instances are compared by address. Otherwise, Lie groups
+      /// with different hashes are different and elementary Lie groups are
+      /// compared one by one.
       bool operator== (const LiegroupSpace& other) const;
       bool operator!= (const LiegroupSpace& other) const;
 
+      /// Cartesian product with another Lie group
+      /// \throw std::logic_error if the instance is canonical.
       LiegroupSpacePtr_t operator*= (const LiegroupSpaceConstPtr_t& other);
 
     protected:
@@ -204,14 +305,24 @@ namespace hpp {
       void computeSize ();
       /// Compute neutral element as a vector
       void computeNeutral ();
+      /// Compute the plan of operations
+      void computeOperations ();
+      /// Compute the hash of the structure
+      void computeHash ();
       typedef std::vector <LiegroupType> LiegroupTypes;
       LiegroupTypes liegroupTypes_;
       /// Size of vector representation and of Lie group tangent space
       size_type nq_, nv_;
       /// Sizes of elementary Lie group
       std::vector <size_type> nqs_, nvs_;
+      /// Compiled plan of operations
+      Operations_t operations_;
       /// Neutral element of the Lie group
       vector_t neutral_;
+      /// Hash of the structure
+      std::size_t hash_;
+      /// Whether this instance is in the registry of canonical instances
+      bool canonical_;
       /// weak pointer to itself
       LiegroupSpaceWkPtr_t weak_;
     }; // class LiegroupSpace
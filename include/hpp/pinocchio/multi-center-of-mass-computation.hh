@@ -0,0 +1,129 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_MULTI_CENTER_OF_MASS_COMPUTATION_HH
+# define HPP_PINOCCHIO_MULTI_CENTER_OF_MASS_COMPUTATION_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+# include <hpp/pinocchio/device.hh>
+# include <hpp/pinocchio/compact-jacobian.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Computation of the centers of mass of several groups of subtrees
+    ///
+    /// Each group is a union of subtrees of the kinematic tree, as in
+    /// CenterOfMassComputation. Groups may overlap, for instance a group
+    /// per robot or object and a group for the whole system.
+    ///
+    /// All groups are computed in a single backward sweep over the joints
+    /// that belong to a group or are ancestors of a group member. The
+    /// contribution of each joint, \f$ m_i {}^0M_i c_i \f$, and its columns
+    /// of the Jacobian in the world frame are computed once and shared by
+    /// the groups.
+    ///
+    /// The Jacobian of the center of mass of a group is stored as a
+    /// CompactJacobian: only the columns of the joints visited for this
+    /// group are stored, the other columns being zero.
+    class HPP_PINOCCHIO_DLLAPI MultiCenterOfMassComputation
+    {
+      public:
+        typedef std::vector <JointIndex> JointRootIndexes_t;
+        typedef std::vector <JointIndex> JointIndexes_t;
+
+        /// Create instance and return shared pointer.
+        static MultiCenterOfMassComputationPtr_t create
+          (const DevicePtr_t& device);
+
+        /// Add an empty group
+        /// \return the index of the new group.
+        std::size_t addGroup ();
+
+        /// Add a subtree to a group
+        /// \param group index of the group, as returned by addGroup,
+        /// \param rootOfSubtree root joint of the subtree.
+        /// \throw std::invalid_argument if the joint already belongs to
+        ///        a subtree of the group.
+        void add (const std::size_t& group, const JointPtr_t& rootOfSubtree);
+
+        /// Compute the center of mass and Jacobian of all groups.
+        ///
+        /// The forward kinematics of the robot must be up to date. If
+        /// the Jacobian is required, it must have been computed with flag
+        /// Device::JACOBIAN.
+        void compute (const Device::Computation_t& flag = Device::ALL);
+
+        /// Number of groups
+        std::size_t size () const { return groups_.size(); }
+
+        /// Get center of mass of a group.
+        const vector3_t& com (const std::size_t& group) const
+        {
+          return groups_[group].com;
+        }
+        /// Get mass of a group.
+        const value_type& mass (const std::size_t& group) const
+        {
+          return groups_[group].mass;
+        }
+        /// Get the Jacobian of the center of mass of a group.
+        const CompactJacobian& jacobian (const std::size_t& group) const
+        {
+          return groups_[group].jacobian;
+        }
+        /// Get const reference to the vector of sub-tree roots of a group.
+        const JointRootIndexes_t& roots (const std::size_t& group) const
+        {
+          return groups_[group].roots;
+        }
+        /// Get const reference to the joints visited by method compute,
+        /// sorted by increasing index.
+        const JointIndexes_t& joints () const { return joints_; }
+
+      protected:
+        MultiCenterOfMassComputation (const DevicePtr_t& device);
+
+      private:
+        struct Group {
+          enum Status_t { NONE = 0, ANCESTOR = 1, MEMBER = 2 };
+
+          JointRootIndexes_t roots;
+          /// Status_t of each joint of the model
+          std::vector <char> status;
+          /// Column of the joints in the compact Jacobian
+          std::vector <size_type> offsets;
+          /// Mass and weighted center of mass of the subtrees
+          std::vector <value_type> masses;
+          std::vector <vector3_t> coms;
+
+          value_type mass;
+          vector3_t com;
+          CompactJacobian jacobian;
+        }; // struct Group
+
+        void updateJoints ();
+
+        DevicePtr_t robot_;
+        std::vector <Group> groups_;
+        /// Union of the joints visited by the groups
+        JointIndexes_t joints_;
+    }; // class MultiCenterOfMassComputation
+  }  // namespace pinocchio
+}  // namespace hpp
+#endif // HPP_PINOCCHIO_MULTI_CENTER_OF_MASS_COMPUTATION_HH
@@ -0,0 +1,175 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_NEAREST_NEIGHBOR_HH
+# define HPP_PINOCCHIO_NEAREST_NEIGHBOR_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    /// k-d tree over configurations of a Device
+    ///
+    /// The splitting dimensions are built from Device::configSpace:
+    /// \li vector space components are split along their coordinate,
+    /// \li \f$SO(2)\f$ components are split along the angle, taking the
+    ///     wrap-around at \f$\pm\pi\f$ into account,
+    /// \li \f$SO(3)\f$ components are split along the quaternion coordinates,
+    ///     taking into account that \f$q\f$ and \f$-q\f$ represent the same
+    ///     rotation.
+    ///
+    /// Distances between configurations are computed by
+    /// hpp::pinocchio::distance so that the index and the metric are always
+    /// consistent. The splitting planes only provide lower bounds of this
+    /// distance, used to prune the search.
+    ///
+    /// Configurations are inserted incrementally. Leaves store up to
+    /// \c bucketSize configurations and are split when they overflow.
+    class HPP_PINOCCHIO_DLLAPI NearestNeighbor
+    {
+      public:
+        typedef std::vector<size_type> Indexes_t;
+        typedef std::vector<value_type> Distances_t;
+
+        /// Create an empty index
+        /// \param robot the robot whose configurations are indexed,
+        /// \param bucketSize maximal number of configurations in a leaf.
+        static NearestNeighborPtr_t create (const DevicePtr_t& robot,
+                                            const size_type& bucketSize = 16);
+
+        /// Insert a configuration
+        /// \return the index of the configuration in this structure.
+        size_type add (ConfigurationIn_t q);
+
+        /// Remove all the configurations
+        void clear ();
+
+        /// Number of configurations stored
+        size_type size () const
+        {
+          return nConfigs_;
+        }
+
+        /// Get configuration at given index
+        ConfigurationIn_t configuration (const size_type& index) const
+        {
+          assert (index < nConfigs_);
+          return configs_.col (index);
+        }
+
+        /// Nearest configuration
+        /// \param q the query configuration,
+        /// \retval distance the distance between q and the result,
+        /// \param eps approximation factor: the returned configuration is
+        ///        at most \f$(1+eps)\f$ farther than the exact nearest
+        ///        neighbor.
+        /// \return the index of the nearest configuration, or -1 if the
+        ///         structure is empty.
+        size_type search (ConfigurationIn_t q, value_type& distance,
+                          const value_type& eps = 0) const;
+
+        /// k nearest configurations
+        /// \param q the query configuration,
+        /// \param k number of requested neighbors,
+        /// \retval indexes the indexes of the neighbors, sorted by
+        ///         increasing distance,
+        /// \retval distances the corresponding distances,
+        /// \param eps approximation factor. See search.
+        void search (ConfigurationIn_t q, const size_type& k,
+                     Indexes_t& indexes, Distances_t& distances,
+                     const value_type& eps = 0) const;
+
+        /// Configurations closer than a given radius
+        /// \param q the query configuration,
+        /// \param radius maximal distance,
+        /// \retval indexes the indexes of the configurations, sorted by
+        ///         increasing distance,
+        /// \retval distances the corresponding distances.
+        void withinBall (ConfigurationIn_t q, const value_type& radius,
+                         Indexes_t& indexes, Distances_t& distances) const;
+
+        /// Get the robot
+        const DevicePtr_t& robot () const
+        {
+          return robot_;
+        }
+
+      protected:
+        NearestNeighbor (const DevicePtr_t& robot, const size_type& bucketSize);
+
+      private:
+        /// Type of splitting dimension
+        enum DimensionType_t {
+          /// Coordinate of a vector space
+          EUCLIDEAN,
+          /// Angle of a unit complex number (cos, sin)
+          ANGLE,
+          /// Coordinate of a unit quaternion
+          QUATERNION
+        };
+        struct Dimension {
+          DimensionType_t type;
+          /// Index of the coordinate in the configuration vector.
+          /// For angles, index of the cosine.
+          size_type iq;
+        };
+        typedef std::vector<Dimension> Dimensions_t;
+
+        struct Node {
+          /// Splitting dimension, -1 for leaves.
+          size_type dim;
+          value_type split;
+          /// Children: left holds values lower than split.
+          size_type left, right;
+          /// Configurations stored in a leaf.
+          Indexes_t points;
+        };
+        typedef std::vector<Node> Nodes_t;
+
+        struct Result;
+        struct DimensionVisitor;
+
+        /// Value of configuration q along dimension d.
+        value_type coordinate (ConfigurationIn_t q, const Dimension& d) const;
+        /// Lower bound of the distance between q and any configuration
+        /// on the other side of the splitting plane of a node.
+        value_type lowerBound (const value_type& x, const Node& node,
+                               const bool upperSide) const;
+
+        void computeDimensions ();
+        void splitLeaf (const size_type& node);
+        void recursiveSearch (const size_type& node, ConfigurationIn_t q,
+                              Result& result) const;
+
+        DevicePtr_t robot_;
+        size_type bucketSize_;
+        Dimensions_t dimensions_;
+        Nodes_t nodes_;
+        /// Configurations stored column-wise.
+        matrix_t configs_;
+        size_type nConfigs_;
+    }; // class NearestNeighbor
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_NEAREST_NEIGHBOR_HH
@@ -0,0 +1,110 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_PINOCCHIO_SPHERE_APPROXIMATION_HH
+# define HPP_PINOCCHIO_SPHERE_APPROXIMATION_HH
+
+# include <vector>
+
+# include <hpp/pinocchio/config.hh>
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Approximation of the geometries of a robot by spheres
+    ///
+    /// Each geometry object is covered by a few spheres, expressed in the
+    /// frame of its joint. All the geometries attached to a joint are
+    /// covered by a sphere centered at the joint origin, whose radius is
+    /// Body::radius. This is the coarsest level of the approximation.
+    ///
+    /// Meshes are cut into slices along the largest dimension of their
+    /// bounding box. Each triangle belongs to the slice of its centroid,
+    /// and each slice is covered by a sphere containing the vertices of
+    /// its triangles. Primitives are covered by one sphere.
+    ///
+    /// The centers are stored as a structure of arrays, so that the
+    /// spheres of a pair of objects are tested with vectorized
+    /// expressions. Objects of which the spheres do not overlap do not
+    /// collide, the other pairs are tested with the exact geometries.
+    class HPP_PINOCCHIO_DLLAPI SphereApproximation
+    {
+      public:
+        /// Create instance and return shared pointer.
+        /// \param spheresPerMesh maximal number of spheres per mesh.
+        static SphereApproximationPtr_t create (const DevicePtr_t& device,
+            const size_type& spheresPerMesh = 8);
+
+        /// Compute the positions of the spheres in the world frame.
+        ///
+        /// The forward kinematics of the robot must be up to date. The
+        /// spheres are built again if geometries were added to the device.
+        /// Until then, the pairs with new geometries always overlap.
+        void compute ();
+
+        /// Whether the spheres of the objects of a collision pair overlap
+        /// \param pairIndex index in GeomModel::collisionPairs
+        /// \return true if the objects may collide, false if they do not.
+        /// \warning Users should call compute first.
+        bool overlap (const std::size_t& pairIndex) const;
+
+        /// Test collision of the current configuration
+        ///
+        /// Pairs are tested with the exact geometries only if their spheres
+        /// overlap. The collision results of the other pairs are cleared.
+        /// \param stopAtFirstCollision act as named
+        /// \warning Users should call compute first.
+        bool collisionTest (const bool stopAtFirstCollision = true);
+
+        /// Number of spheres, excluding the bodies.
+        size_type size () const { return radii_.size(); }
+
+        /// Centers of the spheres in the world frame, one row per
+        /// coordinate.
+        const Eigen::Matrix<value_type, 3, Eigen::Dynamic, Eigen::RowMajor>&
+          centers () const { return centers_; }
+
+        /// Radii of the spheres.
+        const vector_t& radii () const { return radii_; }
+
+      protected:
+        SphereApproximation (const DevicePtr_t& device,
+                             const size_type& spheresPerMesh);
+
+      private:
+        typedef Eigen::Matrix<value_type, 3, Eigen::Dynamic, Eigen::RowMajor>
+          Centers_t;
+
+        /// Build the spheres of all the geometries of the device.
+        void build ();
+        void addSphere (const vector3_t& center, const value_type& radius);
+
+        DevicePtr_t robot_;
+        size_type spheresPerMesh_;
+        /// Centers in the joint frames and in the world frame.
+        Centers_t localCenters_, centers_;
+        vector_t radii_;
+        /// The spheres of geometry i are in [begin_[i], begin_[i+1][.
+        std::vector <size_type> begin_;
+        /// Whether each geometry is approximated.
+        std::vector <bool> approximated_;
+        /// Radii of the bodies
+        vector_t bodyRadii_;
+    }; // class SphereApproximation
+  }  // namespace pinocchio
+}  // namespace hpp
+#endif // HPP_PINOCCHIO_SPHERE_APPROXIMATION_HH
@@ -0,0 +1,288 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_STATIC_LIEGROUP_SPACE_HH
+# define HPP_PINOCCHIO_STATIC_LIEGROUP_SPACE_HH
+
+# include <hpp/util/exception-factory.hh>
+
+# include <hpp/pinocchio/liegroup-space.hh>
+# include <hpp/pinocchio/liegroup-element.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// \addtogroup liegroup
+    /// \{
+
+    namespace details {
+      /// Append the elementary Lie groups of LieGroup to a LiegroupSpace
+      ///
+      /// By default, LieGroup must be one of the types of LiegroupType.
+      template <typename LieGroup> struct AppendLiegroupType
+      {
+        static void run (LiegroupSpace& space)
+        {
+          space *= LiegroupSpace::create (LiegroupType (LieGroup ()));
+        }
+      };
+
+      /// Vector spaces of any size
+      template <int Size> struct AppendLiegroupType
+      <liegroup::VectorSpaceOperation <Size, false> >
+      {
+        static void run (LiegroupSpace& space)
+        {
+          space *= LiegroupSpace::create (Size);
+        }
+      };
+
+      /// Cartesian products are split, except those that are elementary
+      /// Lie groups.
+      template <typename LieGroup1, typename LieGroup2> struct AppendLiegroupType
+      <liegroup::CartesianProductOperation <LieGroup1, LieGroup2> >
+      {
+        static void run (LiegroupSpace& space)
+        {
+          AppendLiegroupType <LieGroup1>::run (space);
+          AppendLiegroupType <LieGroup2>::run (space);
+        }
+      };
+
+      template <> struct AppendLiegroupType
+      <liegroup::CartesianProductOperation <
+         liegroup::VectorSpaceOperation <3, false>,
+         liegroup::SpecialOrthogonalOperation <3> > >
+      {
+        typedef liegroup::CartesianProductOperation <
+          liegroup::VectorSpaceOperation <3, false>,
+          liegroup::SpecialOrthogonalOperation <3> > LieGroup;
+        static void run (LiegroupSpace& space)
+        {
+          space *= LiegroupSpace::create (LiegroupType (LieGroup ()));
+        }
+      };
+
+      template <> struct AppendLiegroupType
+      <liegroup::CartesianProductOperation <
+         liegroup::VectorSpaceOperation <2, false>,
+         liegroup::SpecialOrthogonalOperation <2> > >
+      {
+        typedef liegroup::CartesianProductOperation <
+          liegroup::VectorSpaceOperation <2, false>,
+          liegroup::SpecialOrthogonalOperation <2> > LieGroup;
+        static void run (LiegroupSpace& space)
+        {
+          space *= LiegroupSpace::create (LiegroupType (LieGroup ()));
+        }
+      };
+    } // namespace details
+
+    /// Lie group known at compile time
+    ///
+    /// Cartesian products of elementary Lie groups are written as nested
+    /// liegroup::CartesianProductOperation. For instance, a free-flyer
+    /// followed by a bounded revolute joint and an unbounded one is
+    /// \code
+    /// typedef liegroup::CartesianProductOperation <
+    ///   liegroup::SpecialEuclideanOperation <3>,
+    ///   liegroup::CartesianProductOperation <
+    ///     liegroup::VectorSpaceOperation <1, true>,
+    ///     liegroup::SpecialOrthogonalOperation <2> > > LieGroup;
+    /// typedef StaticLiegroupSpace <LieGroup> Space;
+    /// \endcode
+    ///
+    /// Sizes and offsets of the elementary Lie groups are known at compile
+    /// time, vectors and Jacobians have fixed sizes and operations do not
+    /// dispatch at run time, so that they can be inlined and unrolled by
+    /// the compiler.
+    ///
+    /// The class provides the same operations as LiegroupSpace, and
+    /// conversions of spaces and elements to and from LiegroupSpace.
+    ///
+    /// \tparam LieGroup an elementary Lie group from namespace liegroup, or
+    ///         a cartesian product of those. Vector spaces with rotation
+    ///         flag must be of size 1 or 3, as in LiegroupType.
+    template <typename LieGroup>
+    class StaticLiegroupSpace
+    {
+      public:
+        typedef LieGroup LieGroup_t;
+        enum {
+          /// Dimension of the vector representation
+          NQ = LieGroup::NQ,
+          /// Dimension of the tangent space
+          NV = LieGroup::NV
+        };
+        typedef Eigen::Matrix <value_type, NQ, 1> ConfigVector_t;
+        typedef Eigen::Matrix <value_type, NV, 1> TangentVector_t;
+        typedef Eigen::Matrix <value_type, NV, NV> JacobianMatrix_t;
+
+        /// Dimension of the vector representation
+        static size_type nq ()
+        {
+          return NQ;
+        }
+        /// Dimension of the tangent space
+        static size_type nv ()
+        {
+          return NV;
+        }
+
+        /// Return the neutral element
+        static ConfigVector_t neutral ()
+        {
+          return LieGroup ().neutral ();
+        }
+
+        /// Compute \f$ result = q + v \f$
+        /// result may be the same vector as q.
+        template <typename ConfigIn_t, typename Tangent_t, typename ConfigOut_t>
+        static void integrate (const Eigen::MatrixBase <ConfigIn_t>& q,
+                               const Eigen::MatrixBase <Tangent_t>& v,
+                               const Eigen::MatrixBase <ConfigOut_t>& result)
+        {
+          LieGroup ().integrate (q, v, result);
+        }
+
+        /// Compute \f$ result = q_1 - q_0 \f$
+        template <typename ConfigL_t, typename ConfigR_t, typename Tangent_t>
+        static void difference (const Eigen::MatrixBase <ConfigL_t>& q0,
+                                const Eigen::MatrixBase <ConfigR_t>& q1,
+                                const Eigen::MatrixBase <Tangent_t>& result)
+        {
+          LieGroup ().difference (q0, q1, result);
+        }
+
+        /// Compute the exponential of a tangent vector
+        template <typename Tangent_t, typename ConfigOut_t>
+        static void exp (const Eigen::MatrixBase <Tangent_t>& v,
+                         const Eigen::MatrixBase <ConfigOut_t>& result)
+        {
+          integrate (neutral (), v, result);
+        }
+
+        /// Compute the Jacobian of the integration operation.
+        /// Given \f$ y = x + v \f$,
+        ///
+        /// \param[in] J the Jacobian of x
+        /// \param[out] J the Jacobian of y
+        /// \sa LiegroupSpace::Jintegrate
+        template <typename Tangent_t, typename JacobianOut_t>
+        static void Jintegrate (const Eigen::MatrixBase <Tangent_t>& v,
+                                const Eigen::MatrixBase <JacobianOut_t>& J)
+        {
+          JacobianMatrix_t Jint;
+          LieGroup ().Jintegrate (v, Jint);
+          applyJacobian <true> (Jint, J);
+        }
+
+        /// Compute the Jacobians of the difference operation.
+        /// Given \f$ v = q1 - q0 \f$,
+        ///
+        /// \param[in] J0 the Jacobian of q0.
+        /// \param[in] J1 the Jacobian of q1.
+        /// \param[out] J0 the Jacobian of v with respect to q0.
+        /// \param[out] J1 the Jacobian of v with respect to q1.
+        /// \note to compute only one jacobian, provide for J0 or J1 an empty
+        ///       matrix.
+        /// \sa LiegroupSpace::Jdifference
+        template <bool ApplyOnTheLeft, typename ConfigL_t, typename ConfigR_t,
+                 typename JacobianOut0_t, typename JacobianOut1_t>
+        static void Jdifference (const Eigen::MatrixBase <ConfigL_t>& q0,
+                                 const Eigen::MatrixBase <ConfigR_t>& q1,
+                                 const Eigen::MatrixBase <JacobianOut0_t>& J0,
+                                 const Eigen::MatrixBase <JacobianOut1_t>& J1)
+        {
+          JacobianMatrix_t J0int, J1int;
+          LieGroup ().Jdifference (q0, q1, J0int, J1int);
+          if (J0.size () > 0) applyJacobian <ApplyOnTheLeft> (J0int, J0);
+          if (J1.size () > 0) applyJacobian <ApplyOnTheLeft> (J1int, J1);
+        }
+
+        /// \name Conversion to and from LiegroupSpace
+        /// \{
+
+        /// Get the equivalent dynamic Lie group
+        /// \return a canonical instance of LiegroupSpace.
+        static const LiegroupSpacePtr_t& dynamicSpace ()
+        {
+          static const LiegroupSpacePtr_t space (createDynamicSpace ());
+          return space;
+        }
+
+        /// Whether a dynamic Lie group is this Lie group
+        static bool isCompatible (const LiegroupSpace& space)
+        {
+          return *dynamicSpace () == space;
+        }
+
+        /// Convert a vector to an element of the dynamic Lie group
+        static LiegroupElement element (const ConfigVector_t& q)
+        {
+          return LiegroupElement (q, dynamicSpace ());
+        }
+
+        /// Convert an element of a dynamic Lie group
+        /// \throw std::invalid_argument if the element does not belong to
+        ///        this Lie group.
+        template <typename vector_type>
+        static ConfigVector_t vector
+        (const LiegroupElementBase <vector_type>& element)
+        {
+          if (!isCompatible (*element.space ()))
+            HPP_THROW (std::invalid_argument, "Element of "
+                << *element.space () << " does not belong to "
+                << *dynamicSpace ());
+          return element.vector ();
+        }
+        /// \}
+
+      private:
+        /// Compute \f$ J \leftarrow B J \f$ or \f$ J \leftarrow J B \f$
+        /// without allocating.
+        template <bool OnTheLeft, typename JacobianOut_t>
+        static void applyJacobian (const JacobianMatrix_t& B,
+                                   const Eigen::MatrixBase <JacobianOut_t>& Jout)
+        {
+          JacobianOut_t& J (const_cast <JacobianOut_t&> (Jout.derived ()));
+          TangentVector_t tmp;
+          if (OnTheLeft) {
+            assert (J.rows () == NV);
+            for (size_type c = 0; c < J.cols (); ++c) {
+              tmp.noalias () = B * J.col (c);
+              J.col (c) = tmp;
+            }
+          } else {
+            assert (J.cols () == NV);
+            for (size_type r = 0; r < J.rows (); ++r) {
+              tmp.noalias () = B.transpose () * J.row (r).transpose ();
+              J.row (r) = tmp.transpose ();
+            }
+          }
+        }
+
+        static LiegroupSpacePtr_t createDynamicSpace ()
+        {
+          LiegroupSpacePtr_t space (LiegroupSpace::empty ());
+          details::AppendLiegroupType <LieGroup>::run (*space);
+          return LiegroupSpace::canonical (space);
+        }
+    }; // class StaticLiegroupSpace
+    /// \}
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_STATIC_LIEGROUP_SPACE_HH
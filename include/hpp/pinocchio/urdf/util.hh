@@ -115,6 +115,63 @@ namespace hpp
                                 const std::string& rootType,
                                 const std::string& urdfString,
                                 const std::string& srdfString);
+
+      /// Set the directory of the model cache
+      ///
+      /// When the directory is not empty, the collision geometries and the
+      /// collision pairs of models loaded by loadModel and
+      /// loadModelFromString are stored in a binary file of this
+      /// directory. The file is keyed by the content of the URDF, SRDF and
+      /// mesh files. Next loads of the same files read the meshes and
+      /// collision pairs from this file instead of parsing them. Invalid
+      /// or missing files are silently ignored.
+      ///
+      /// The initial value is the environment variable
+      /// HPP_PINOCCHIO_CACHE_DIR, if defined.
+      /// \param directory an existing directory, or an empty string to
+      ///        disable the cache.
+      /// \note the directory can be set and read from several threads.
+      void cacheDirectory (const std::string& directory);
+
+      /// Get the directory of the model cache
+      /// \sa cacheDirectory (const std::string&)
+      std::string cacheDirectory ();
+
+      /// When loadModel and loadModelFromString load the geometries
+      /// \sa Device::deferGeometry
+      enum GeometryLoading_t {
+        /// Geometries are loaded with the kinematic model.
+        LOAD_GEOMETRY_NOW,
+        /// Geometries are loaded at the first access to the geometry model
+        /// or data of the device.
+        LOAD_GEOMETRY_ON_DEMAND,
+        /// Geometries are loaded in a separate thread, while the kinematic
+        /// model is usable. The first access to the geometry model or data
+        /// of the device waits for this thread.
+        LOAD_GEOMETRY_IN_BACKGROUND
+      };
+
+      /// Set when geometries are loaded
+      ///
+      /// The initial value is LOAD_GEOMETRY_NOW. The other modes avoid
+      /// loading meshes, building their BVH and computing the body radii
+      /// for applications that only use the kinematic model.
+      void geometryLoading (GeometryLoading_t mode);
+
+      /// Get when geometries are loaded
+      /// \sa geometryLoading (GeometryLoading_t)
+      GeometryLoading_t geometryLoading ();
+
+      /// Set the number of threads that load the meshes of a model
+      ///
+      /// Each mesh is imported and its BVH built by one thread.
+      /// \param n number of threads. 0, the initial value, means as many
+      ///        threads as the hardware supports.
+      void geometryLoadingThreads (std::size_t n);
+
+      /// Get the number of threads that load the meshes of a model
+      /// \sa geometryLoadingThreads (std::size_t)
+      std::size_t geometryLoadingThreads ();
     } // end of namespace urdf.
   } // end of namespace pinocchio.
 } // end of namespace hpp.
@@ -0,0 +1,108 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/block-diagonal-matrix.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    BlockDiagonalMatrix::BlockDiagonalMatrix (const size_type& size) :
+      size_ (0), end_ (0), blocks_ (), dense_ ()
+    {
+      resize (size);
+    }
+
+    void BlockDiagonalMatrix::resize (const size_type& size)
+    {
+      size_ = size;
+      end_ = 0;
+      blocks_.clear ();
+      if (dense_.rows () < size_) dense_.resize (size_, MaxDenseSize);
+    }
+
+    void BlockDiagonalMatrix::pushIdentity (const size_type& size, bool minus)
+    {
+      assert (end_ + size <= size_);
+      const Block::Kind_t kind (minus ? Block::MINUS_IDENTITY
+                                : Block::IDENTITY);
+      if (!blocks_.empty () && blocks_.back ().kind == kind) {
+        blocks_.back ().size += size;
+      } else {
+        Block b; b.kind = kind; b.index = end_; b.size = size;
+        blocks_.push_back (b);
+      }
+      end_ += size;
+    }
+
+    void BlockDiagonalMatrix::applyOnTheLeft (matrixOut_t J) const
+    {
+      assert (end_ == size_);
+      assert (J.rows () == size_);
+      for (std::size_t i = 0; i < blocks_.size (); ++i) {
+        const Block& b (blocks_ [i]);
+        switch (b.kind) {
+          case Block::IDENTITY:
+            break;
+          case Block::MINUS_IDENTITY:
+            J.middleRows (b.index, b.size) *= -1;
+            break;
+          case Block::DENSE:
+            applyDenseOnTheLeft (dense (b), b.index, J);
+            break;
+        }
+      }
+    }
+
+    void BlockDiagonalMatrix::applyOnTheRight (matrixOut_t J) const
+    {
+      assert (end_ == size_);
+      assert (J.cols () == size_);
+      for (std::size_t i = 0; i < blocks_.size (); ++i) {
+        const Block& b (blocks_ [i]);
+        switch (b.kind) {
+          case Block::IDENTITY:
+            break;
+          case Block::MINUS_IDENTITY:
+            J.middleCols (b.index, b.size) *= -1;
+            break;
+          case Block::DENSE:
+            applyDenseOnTheRight (dense (b), b.index, J);
+            break;
+        }
+      }
+    }
+
+    matrix_t BlockDiagonalMatrix::matrix () const
+    {
+      assert (end_ == size_);
+      matrix_t result (matrix_t::Zero (size_, size_));
+      for (std::size_t i = 0; i < blocks_.size (); ++i) {
+        const Block& b (blocks_ [i]);
+        switch (b.kind) {
+          case Block::IDENTITY:
+            result.diagonal ().segment (b.index, b.size).setOnes ();
+            break;
+          case Block::MINUS_IDENTITY:
+            result.diagonal ().segment (b.index, b.size).setConstant (-1);
+            break;
+          case Block::DENSE:
+            result.block (b.index, b.index, b.size, b.size) = dense (b);
+            break;
+        }
+      }
+      return result;
+    }
+  } // namespace pinocchio
+} // namespace hpp
@@ -0,0 +1,68 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_PINOCCHIO_SRC_BOUNDING_SPHERE_HH
+# define HPP_PINOCCHIO_SRC_BOUNDING_SPHERE_HH
+
+# include <cmath>
+
+# include <hpp/fcl/collision_object.h>
+# include <hpp/fcl/shape/geometric_shapes.h>
+
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    namespace details {
+      /// Radius of the sphere centered at the origin that covers a primitive
+      /// \return a negative value if the geometry is not a supported
+      ///         primitive.
+      inline value_type primitiveRadius (const fcl::CollisionGeometry& g)
+      {
+        switch (g.getNodeType()) {
+          case fcl::GEOM_BOX: {
+            const fcl::Vec3f& s (static_cast<const fcl::Box&> (g).side);
+            return .5 * std::sqrt (s[0]*s[0] + s[1]*s[1] + s[2]*s[2]);
+          }
+          case fcl::GEOM_SPHERE:
+            return static_cast<const fcl::Sphere&> (g).radius;
+          case fcl::GEOM_CAPSULE: {
+            const fcl::Capsule& c (static_cast<const fcl::Capsule&> (g));
+            return c.radius + .5 * c.lz;
+          }
+          case fcl::GEOM_CONE: {
+            const fcl::Cone& c (static_cast<const fcl::Cone&> (g));
+            return std::sqrt (c.radius * c.radius + .25 * c.lz * c.lz);
+          }
+          case fcl::GEOM_CYLINDER: {
+            const fcl::Cylinder& c (static_cast<const fcl::Cylinder&> (g));
+            return std::sqrt (c.radius * c.radius + .25 * c.lz * c.lz);
+          }
+          default:
+            return -1;
+        }
+      }
+
+      inline vector3_t toVector3 (const fcl::Vec3f& v)
+      {
+        return vector3_t (v[0], v[1], v[2]);
+      }
+    } // namespace details
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_SRC_BOUNDING_SPHERE_HH
@@ -20,7 +20,6 @@
 #include <boost/foreach.hpp>
 
 #include <pinocchio/algorithm/center-of-mass.hpp>
-#include <pinocchio/algorithm/copy.hpp>
 
 #include <hpp/util/exception-factory.hh>
 
@@ -39,109 +38,222 @@ namespace hpp {
 
     void CenterOfMassComputation::compute (const Device::Computation_t& flag)
     {
-      const Model& model = robot_->model();
-
       bool computeCOM = (flag & Device::COM);
       bool computeJac = (flag & Device::JACOBIAN);
       assert(computeCOM && "This does nothing");
       assert (!(computeJac && !computeCOM)); // JACOBIAN => COM
 
-      // update kinematics
-      se3::copy<0>(model,robot_->data(),data);
+      if (upToDate_ && (jacobianUpToDate_ || !computeJac)
+          && findChangedJoints ())
+        computeIncremental (computeJac);
+      else
+        computeAll (computeJac);
 
-      data.mass[0] = 0;
-      if(computeCOM) data.com[0].setZero();
-      if(computeJac) data.Jcom.setZero();
-    
-      // Propagate COM initialization on all joints. 
-      // Could be done only on subtree, with minor gain (possibly loss because of 
-      // more difficult branch prediction). I dont recommend to implement it.
-      for(JointIndex jid=1;jid<JointIndex(model.joints.size());++jid)
+      if (computeJac)
         {
-          const double &            mass  = model.inertias[jid].mass ();
+          const CompactJacobian::ColumnIndexes_t& columns
+            (compactJacobian_.columns());
+          for (std::size_t c = 0; c < columns.size(); ++c)
+            compactJacobian_.matrix().col(c) = data.Jcom.col(columns[c]);
+        }
+
+      upToDate_ = true;
+      jacobianUpToDate_ = computeJac;
+    }
+
+    void CenterOfMassComputation::initialize (const std::size_t& i)
+    {
+      const Model& model = robot_->model();
+      const JointIndex jid = joints_[i];
+      data.oMi[jid] = robot_->data().oMi[jid];
+      // Ancestors that do not belong to a subtree carry no mass.
+      if (inSubtree_[i])
+        {
+          const double & mass = model.inertias[jid].mass ();
+          masses_[jid] = mass;
+          levers_[jid] = model.inertias[jid].lever();
           data.mass[jid] = mass;
           data.com [jid] = mass*data.oMi[jid].act (model.inertias[jid].lever());
         }
+      else
+        {
+          data.mass[jid] = 0;
+          data.com [jid].setZero();
+        }
+    }
 
-      // Nullify non-subtree com and mass.
-      int root = 0;
-      for(JointIndex jid=1; std::size_t(jid)<model.joints.size(); ++jid )
+    void CenterOfMassComputation::backwardStep (const JointIndex& jid,
+                                                bool computeJac)
+    {
+      const Model& model = robot_->model();
+      if(computeJac)
+        se3::JacobianCenterOfMassBackwardStep
+          ::run(model.joints[jid],data.joints[jid],
+                se3::JacobianCenterOfMassBackwardStep::ArgsType(model,data,false));
+      else
         {
-          const JointIndex& rootId = roots_[root];
-          if(jid == rootId)
-            {
-              jid = data.lastChild[rootId];
-              root ++;
-            }
-          else 
+          const JointIndex & parent = model.parents[jid];
+          data.com [parent] += data.com [jid];
+          data.mass[parent] += data.mass[jid];
+        }
+    }
+
+    void CenterOfMassComputation::computeAll (bool computeJac)
+    {
+      const Model& model = robot_->model();
+
+      data.mass[0] = 0;
+      data.com[0].setZero();
+
+      // Update kinematics and initialize COM of the visited joints only.
+      for (std::size_t i = 0; i < joints_.size(); ++i)
+        initialize (i);
+
+      // Backward loop on visited joints. As joints_ is sorted, children are
+      // visited before their parent, and the parent of a visited joint is
+      // either visited or the universe.
+      for (std::size_t i = joints_.size(); i-- > 0;)
+        backwardStep (joints_[i], computeJac);
+
+      data.com[0]  /= data.mass[0];
+      // Columns of the joints that are not visited are zero.
+      if(computeJac)
+        for (std::size_t i = 0; i < joints_.size(); ++i)
+          {
+            const se3::JointModel& joint = model.joints[joints_[i]];
+            data.Jcom.middleCols (joint.idx_v(), joint.nv()) /= data.mass[0];
+          }
+    }
+
+    bool CenterOfMassComputation::findChangedJoints ()
+    {
+      const Model& model = robot_->model();
+      const Data& current = robot_->data();
+
+      changedRoots_.clear();
+      std::size_t nChanged = 0;
+      // As joints_ is sorted, the status of the parent is known.
+      for (std::size_t i = 0; i < joints_.size(); ++i)
+        {
+          const JointIndex jid = joints_[i];
+          // A change of mass changes every column of the Jacobian.
+          if (inSubtree_[i] &&
+              (model.inertias[jid].mass() != masses_[jid] ||
+               model.inertias[jid].lever() != levers_[jid]))
+            return false;
+          changed_[jid] = NOT_CHANGED;
+          if (changed_[model.parents[jid]] == CHANGED)
+            changed_[jid] = CHANGED;
+          // The placement of the joint changes with the configuration and
+          // with the placement of the joint in its parent.
+          else if (current.oMi[jid].rotation() != data.oMi[jid].rotation() ||
+                   current.oMi[jid].translation() !=
+                   data.oMi[jid].translation())
             {
-              data.mass[jid] = 0;
-              data.com [jid] .setZero();
+              changed_[jid] = CHANGED;
+              changedRoots_.push_back (jid);
             }
+          if (changed_[jid] == CHANGED) ++nChanged;
         }
+      // Above this ratio, the full computation is cheaper.
+      if (2 * nChanged > joints_.size()) return false;
 
-      // Assume root is sorted from smallest id.
-      // Nasty cast below, from (u-long) size_t to int.
-      for( int root=int(roots_.size()-1); root>=0; --root )
-      {
-        JointIndex rootId = roots_[root];
+      // Ancestors of changed subtrees
+      BOOST_FOREACH (const JointIndex root, changedRoots_)
+        for (JointIndex jid = model.parents[root];
+             jid > 0 && changed_[jid] == NOT_CHANGED;
+             jid = model.parents[jid])
+          changed_[jid] = ANCESTOR_CHANGED;
+      return true;
+    }
 
-        // Backward loop on descendents of joint rootId.
-        for( JointIndex jid = data.lastChild[rootId];jid>=rootId;--jid )
-          {
-            if(computeJac)
-              se3::JacobianCenterOfMassBackwardStep
-                ::run(model.joints[jid],data.joints[jid],
-                      se3::JacobianCenterOfMassBackwardStep::ArgsType(model,data,false));
-            else
-              {
-                assert(computeCOM);
-                const JointIndex & parent = model.parents[jid];
-                data.com [parent] += data.com [jid];
-                data.mass[parent] += data.mass[jid];
-              }
+    void CenterOfMassComputation::computeIncremental (bool computeJac)
+    {
+      const Model& model = robot_->model();
+
+      if (changedRoots_.empty()) return;
+
+      // Work on the weighted sum of the centers of mass.
+      data.com[0] *= data.mass[0];
+
+      BOOST_FOREACH (const JointIndex root, changedRoots_)
+        {
+          const JointIndex parent = model.parents[root];
+          const vector3_t oldCom (data.com[root]);
+
+          // Remove the contribution of the subtree from its parent, which
+          // the backward step of root adds again.
+          data.com [parent] -= data.com [root];
+          data.mass[parent] -= data.mass[root];
+
+          // Recompute the visited joints of the subtree
+          std::size_t begin = std::lower_bound (joints_.begin(), joints_.end(),
+                                                root) - joints_.begin();
+          std::size_t end = std::upper_bound (joints_.begin(), joints_.end(),
+                                              JointIndex(data.lastChild[root]))
+            - joints_.begin();
+          for (std::size_t i = begin; i < end; ++i)
+            initialize (i);
+          for (std::size_t i = end; i-- > begin;)
+            backwardStep (joints_[i], computeJac);
+
+          // Propagate the change to the other ancestors.
+          const vector3_t delta (data.com[root] - oldCom);
+          for (JointIndex jid = parent; jid > 0;)
+            {
+              jid = model.parents[jid];
+              data.com[jid] += delta;
+            }
+        }
 
-            //std::cout << data.oMi [jid] << std::endl;
-            //std::cout << data.mass[jid] << std::endl;
-            //std::cout << data.com [jid].transpose() << std::endl;
-          } // end for jid
+      data.com[0]  /= data.mass[0];
 
-        // Backward loop on ancestors of joint rootId
-        JointIndex jid = model.parents[rootId]; // loop variable
-        rootId = (root>0) ? roots_[root-1] : 0;      // root of previous subtree in roots_
-        while (jid>rootId)                           // stop when meeting the next subtree
+      // Columns of the changed joints have just been computed. Columns of
+      // their ancestors depend on the center of mass of their subtree.
+      if(computeJac)
+        for (std::size_t i = 0; i < joints_.size(); ++i)
           {
-            const JointIndex & parent = model.parents[jid];
-            if(computeJac)
-              se3::JacobianCenterOfMassBackwardStep
-                ::run(model.joints[jid],data.joints[jid],
-                      se3::JacobianCenterOfMassBackwardStep::ArgsType(model,data,false));
-            else
+            const JointIndex jid = joints_[i];
+            const se3::JointModel& joint = model.joints[jid];
+            switch (changed_[jid])
               {
-                assert(computeCOM);
-                data.com [parent] += data.com [jid];
-                data.mass[parent] += data.mass[jid];
+                case NOT_CHANGED:
+                  break;
+                case CHANGED:
+                  data.Jcom.middleCols (joint.idx_v(), joint.nv()) /= data.mass[0];
+                  break;
+                case ANCESTOR_CHANGED:
+                  for (int c = 0; c < joint.nv(); ++c)
+                    {
+                      const size_type iv = joint.idx_v() + c;
+                      data.Jcom.col(iv) = (data.mass[jid] * data.J.col(iv).head<3>()
+                          - data.com[jid].cross (data.J.col(iv).tail<3>()))
+                        / data.mass[0];
+                    }
+                  break;
               }
-            jid = parent;
-          } // end while
-
-      } // end for root in roots_
-      
-      if(computeCOM) data.com[0]  /= data.mass[0];
-      if(computeJac) data.Jcom    /= data.mass[0];
+          }
     }
 
     CenterOfMassComputation::CenterOfMassComputation (const DevicePtr_t& d) :
-      robot_(d), roots_ (), //mass_ (0), jacobianCom_ (3, d->numberDof ())
-      data(d->model())
-    { assert (d->modelPtr()); }
+      robot_(d), roots_ (), joints_ (), inSubtree_ (),
+      upToDate_ (false), jacobianUpToDate_ (false),
+      changed_ (d->model().joints.size(), NOT_CHANGED), changedRoots_ (),
+      masses_ (d->model().joints.size(), 0),
+      levers_ (d->model().joints.size(), vector3_t::Zero()),
+      compactJacobian_ (), data(d->model())
+    {
+      assert (d->modelPtr());
+      data.Jcom.setZero();
+    }
 
     void CenterOfMassComputation::add (const JointPtr_t& j)
     {
+      const Model& model = robot_->model();
       JointIndex jid = j->index();
       BOOST_FOREACH( const JointIndex rootId,  roots_ )
         {
-          assert (std::size_t(rootId)<robot_->model().joints.size());
+          assert (std::size_t(rootId)<model.joints.size());
           // Assert that the new root is not in already-recorded subtrees.
           if( (jid >= rootId) && (data.lastChild[rootId] >= int(jid)) )
             // We are doing something stupid. Should we throw an error
@@ -152,6 +264,31 @@ namespace hpp {
         }
 
       roots_.push_back(jid);
+      upToDate_ = false;
+
+      // Update the list of visited joints.
+      // 0: not visited, 1: ancestor of a subtree, 2: in a subtree.
+      std::vector<char> status (model.joints.size(), 0);
+      for (std::size_t i = 0; i < joints_.size(); ++i)
+        status[joints_[i]] = (inSubtree_[i] ? 2 : 1);
+      for (JointIndex k = jid; k <= JointIndex(data.lastChild[jid]); ++k)
+        status[k] = 2;
+      for (JointIndex k = model.parents[jid]; k > 0; k = model.parents[k])
+        if (status[k] == 0) status[k] = 1;
+
+      joints_.clear();
+      inSubtree_.clear();
+      CompactJacobian::ColumnIndexes_t columns;
+      for (JointIndex k = 1; k < JointIndex(model.joints.size()); ++k)
+        if (status[k] != 0)
+          {
+            joints_.push_back(k);
+            inSubtree_.push_back(status[k] == 2);
+            const se3::JointModel& joint = model.joints[k];
+            for (int i = 0; i < joint.nv(); ++i)
+              columns.push_back (joint.idx_v() + i);
+          }
+      compactJacobian_.setColumns (3, model.nv, columns);
     }
 
     CenterOfMassComputation::~CenterOfMassComputation ()
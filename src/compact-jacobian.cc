@@ -0,0 +1,76 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/compact-jacobian.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    void CompactJacobian::setColumns (const size_type& rows,
+                                      const size_type& cols,
+                                      const ColumnIndexes_t& columns)
+    {
+      assert (columns.size () <= std::size_t (cols));
+      columns_ = columns;
+      cols_ = cols;
+      matrix_.setZero (rows, columns_.size ());
+    }
+
+    void CompactJacobian::multiply (vectorIn_t v, vectorOut_t result) const
+    {
+      assert (v.size () == cols_);
+      assert (result.size () == rows ());
+      result.setZero ();
+      for (std::size_t c = 0; c < columns_.size (); ++c)
+        result.noalias () += matrix_.col (c) * v[columns_[c]];
+    }
+
+    void CompactJacobian::multiplyMatrix (matrixIn_t A,
+                                          matrixOut_t result) const
+    {
+      assert (A.rows () == cols_);
+      assert (result.rows () == rows ());
+      assert (result.cols () == A.cols ());
+      result.setZero ();
+      for (std::size_t c = 0; c < columns_.size (); ++c)
+        result.noalias () += matrix_.col (c) * A.row (columns_[c]);
+    }
+
+    void CompactJacobian::transposeMultiply (vectorIn_t w,
+                                             vectorOut_t result) const
+    {
+      assert (w.size () == rows ());
+      assert (result.size () == cols_);
+      result.setZero ();
+      for (std::size_t c = 0; c < columns_.size (); ++c)
+        result[columns_[c]] = matrix_.col (c).dot (w);
+    }
+
+    void CompactJacobian::addTo (matrixOut_t result) const
+    {
+      assert (result.rows () == rows ());
+      assert (result.cols () == cols_);
+      for (std::size_t c = 0; c < columns_.size (); ++c)
+        result.col (columns_[c]) += matrix_.col (c);
+    }
+
+    matrix_t CompactJacobian::dense () const
+    {
+      matrix_t result (matrix_t::Zero (rows (), cols_));
+      addTo (result);
+      return result;
+    }
+  }  //  namespace pinocchio
+}  //  namespace hpp
@@ -0,0 +1,296 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/configuration-metric.hh>
+
+#include <algorithm>
+#include <cmath>
+
+#include <pinocchio/multibody/model.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+
+#include <hpp/util/exception-factory.hh>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/joint.hh>
+#include <hpp/pinocchio/body.hh>
+#include <hpp/pinocchio/liegroup-space.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Decompose the configuration space of a joint into elements.
+    struct ConfigurationMetric::ElementVisitor : public boost::static_visitor <>
+    {
+      ElementVisitor (Elements_t& elements, const size_type& joint,
+                      const size_type& iq)
+        : elements_ (elements), joint_ (joint), iq_ (iq) {}
+
+      void push (ElementType_t type, const size_type& nq)
+      {
+        Element e; e.type = type; e.joint = joint_; e.iq = iq_; e.nq = nq;
+        elements_.push_back (e);
+        iq_ += nq;
+      }
+
+      template <int N, bool rot>
+      void operator () (const liegroup::VectorSpaceOperation<N, rot>& lg)
+      {
+        push (rot ? ROTATION : TRANSLATION, lg.nq ());
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<2>&)
+      {
+        push (SO2, 2);
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<3>&)
+      {
+        push (SO3, 4);
+      }
+
+      template <typename LgT1, typename LgT2>
+      void operator () (const liegroup::CartesianProductOperation<LgT1, LgT2>&)
+      {
+        (*this) (LgT1 ());
+        (*this) (LgT2 ());
+      }
+
+      void operator () (const se3::SpecialEuclideanOperation<2>&)
+      {
+        push (SE2, 4);
+      }
+
+      void operator () (const se3::SpecialEuclideanOperation<3>&)
+      {
+        push (SE3, 7);
+      }
+
+      Elements_t& elements_;
+      size_type joint_, iq_;
+    }; // struct ElementVisitor
+
+    namespace {
+      inline value_type so2SquaredDistance (ConfigurationIn_t q1,
+          ConfigurationIn_t q2, const size_type& iq)
+      {
+        const value_type& c1 (q1[iq]), s1 (q1[iq+1]),
+                          c2 (q2[iq]), s2 (q2[iq+1]);
+        const value_type angle (std::atan2 (c1 * s2 - s1 * c2,
+                                            c1 * c2 + s1 * s2));
+        return angle * angle;
+      }
+
+      /// Angle of the rotation \f$ q_1^{-1} q_2 \f$. Quaternions are stored
+      /// as (x, y, z, w).
+      inline value_type so3SquaredDistance (ConfigurationIn_t q1,
+          ConfigurationIn_t q2, const size_type& iq)
+      {
+        const vector3_t v1 (q1.segment<3>(iq)), v2 (q2.segment<3>(iq));
+        const value_type& w1 (q1[iq+3]), w2 (q2[iq+3]);
+        const value_type w (w1 * w2 + v1.dot (v2));
+        const vector3_t v (w1 * v2 - w2 * v1 - v1.cross (v2));
+        const value_type angle (2 * std::atan2 (v.norm (), std::fabs (w)));
+        return angle * angle;
+      }
+    }
+
+    ConfigurationMetricPtr_t ConfigurationMetric::create
+    (const DevicePtr_t& robot)
+    {
+      return ConfigurationMetricPtr_t (new ConfigurationMetric (robot));
+    }
+
+    ConfigurationMetric::ConfigurationMetric (const DevicePtr_t& robot)
+      : robot_ (robot), weights_ (), elements_ (), coordinateWeights_ (),
+      segments_ ()
+    {
+      computeElements ();
+      weights_ = vector_t::Ones (robot_->getJointVector ().size ());
+      update ();
+    }
+
+    void ConfigurationMetric::computeElements ()
+    {
+      // Decompose the configuration space of the robot, which is the one
+      // used by hpp::pinocchio::distance (e.g. SE(3) for free-flyers).
+      const size_type nq (robot_->model ().nq);
+      Elements_t elements;
+      const LiegroupSpacePtr_t& space (robot_->configSpace ());
+      ElementVisitor visitor (elements, -1, 0);
+      for (std::size_t k = 0; k < space->liegroupTypes ().size (); ++k)
+        boost::apply_visitor (visitor, space->liegroupTypes () [k]);
+      assert (visitor.iq_ == robot_->configSize ());
+
+      // Rank of the joint of each coordinate in the joint vector
+      const JointVector& jv (robot_->getJointVector ());
+      std::vector<size_type> jointOf (nq, -1);
+      for (size_type i = 0; i < jv.size (); ++i) {
+        JointPtr_t joint (jv.at (i));
+        for (size_type j = 0; j < joint->configSize (); ++j)
+          jointOf [joint->rankInConfiguration () + j] = i;
+      }
+
+      // Vector spaces of consecutive joints are merged in the configuration
+      // space of the robot: split them by joint. The extra configuration
+      // space is handled separately.
+      elements_.clear ();
+      for (std::size_t i = 0; i < elements.size (); ++i) {
+        Element e (elements [i]);
+        const size_type end (std::min (e.iq + e.nq, nq));
+        while (e.iq < end) {
+          e.joint = jointOf [e.iq];
+          size_type last (e.iq + 1);
+          while (last < end && jointOf [last] == e.joint) ++last;
+          assert ((e.type == TRANSLATION || e.type == ROTATION)
+                  || last - e.iq == e.nq);
+          Element part (e);
+          part.nq = last - e.iq;
+          elements_.push_back (part);
+          e.iq = last;
+        }
+      }
+    }
+
+    void ConfigurationMetric::weights (vectorIn_t weights)
+    {
+      if (weights.size () != weights_.size ())
+        HPP_THROW (std::invalid_argument, "Expected vector of size "
+            << weights_.size () << ", got size " << weights.size ());
+      weights_ = weights;
+      update ();
+    }
+
+    void ConfigurationMetric::update ()
+    {
+      const size_type extraDim = robot_->extraConfigSpace ().dimension ();
+      coordinateWeights_ = vector_t::Zero (robot_->configSize ());
+      coordinateWeights_.tail (extraDim).setOnes ();
+      segments_.clear ();
+      for (std::size_t i = 0; i < elements_.size (); ++i) {
+        const Element& e (elements_ [i]);
+        const value_type w2 (weights_ [e.joint] * weights_ [e.joint]);
+        switch (e.type) {
+          case TRANSLATION:
+          case ROTATION:
+            coordinateWeights_.segment (e.iq, e.nq).setConstant (w2);
+            break;
+          default:
+            Segment s; s.type = e.type; s.iq = e.iq; s.w2 = w2;
+            segments_.push_back (s);
+            break;
+        }
+      }
+    }
+
+    void ConfigurationMetric::computeWeights (const bool massWeighted,
+        const value_type& minimalWeight)
+    {
+      const Model& model (robot_->model ());
+      const JointVector& jv (robot_->getJointVector ());
+      const bool hasGeometry (robot_->geomDataPtr () &&
+          robot_->geomData ().radius.size () == model.joints.size ());
+
+      // Pinocchio joint indexes are shifted by one with respect to the joint
+      // vector since the first joint of the model is the universe.
+      const std::size_t n (model.joints.size ());
+      std::vector<value_type> radius (n, 0), mass (n, 0);
+      for (std::size_t i = 1; i < n; ++i) {
+        if (hasGeometry) {
+          BodyPtr_t body (jv.at (i - 1)->linkedBody ());
+          if (body) radius [i] = body->radius ();
+        }
+        mass [i] = model.inertias [i].mass ();
+      }
+      // Children have greater indexes than their parent.
+      for (std::size_t i = n - 1; i > 0; --i) {
+        const std::size_t parent (model.parents [i]);
+        if (parent == 0) continue;
+        radius [parent] = std::max (radius [parent],
+            jv.at (i - 1)->maximalDistanceToParent () + radius [i]);
+        mass [parent] += mass [i];
+      }
+      value_type totalMass = 0;
+      for (std::size_t i = 1; i < n; ++i)
+        if (model.parents [i] == 0) totalMass += mass [i];
+
+      vector_t weights (vector_t::Ones (weights_.size ()));
+      for (std::size_t i = 0; i < elements_.size (); ++i) {
+        const Element& e (elements_ [i]);
+        const std::size_t idx (e.joint + 1);
+        switch (e.type) {
+          case TRANSLATION:
+            break;
+          case ROTATION:
+          case SO2:
+          case SO3:
+            weights [e.joint] = radius [idx];
+            break;
+          case SE2:
+          case SE3:
+            // The weight also applies to the translation.
+            weights [e.joint] = std::max (value_type (1), radius [idx]);
+            break;
+        }
+      }
+      for (size_type j = 0; j < weights.size (); ++j) {
+        if (massWeighted && totalMass > 0)
+          weights [j] *= mass [j + 1] / totalMass;
+        weights [j] = std::max (weights [j], minimalWeight);
+      }
+      weights_ = weights;
+      update ();
+    }
+
+    value_type ConfigurationMetric::squaredDistance (ConfigurationIn_t q1,
+        ConfigurationIn_t q2) const
+    {
+      assert (q1.size () == robot_->configSize ());
+      assert (q2.size () == robot_->configSize ());
+      // Non vector space coordinates have a zero weight.
+      value_type res = (coordinateWeights_.array ()
+          * (q2 - q1).array ().square ()).sum ();
+      for (std::size_t i = 0; i < segments_.size (); ++i) {
+        const Segment& s (segments_ [i]);
+        switch (s.type) {
+          case SO2:
+            res += s.w2 * so2SquaredDistance (q1, q2, s.iq);
+            break;
+          case SO3:
+            res += s.w2 * so3SquaredDistance (q1, q2, s.iq);
+            break;
+          case SE2:
+            res += s.w2 * se3::SpecialEuclideanOperation<2> ().squaredDistance
+              (q1.segment<4> (s.iq), q2.segment<4> (s.iq));
+            break;
+          case SE3:
+            res += s.w2 * se3::SpecialEuclideanOperation<3> ().squaredDistance
+              (q1.segment<7> (s.iq), q2.segment<7> (s.iq));
+            break;
+          default:
+            assert (false && "Vector space segments should not be stored.");
+            break;
+        }
+      }
+      return res;
+    }
+
+    value_type ConfigurationMetric::distance (ConfigurationIn_t q1,
+        ConfigurationIn_t q2) const
+    {
+      return std::sqrt (squaredDistance (q1, q2));
+    }
+  } // namespace pinocchio
+} // namespace hpp
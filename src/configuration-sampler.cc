@@ -0,0 +1,193 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/configuration-sampler.hh>
+
+#include <cmath>
+
+#include <pinocchio/multibody/model.hpp>
+
+#include <hpp/util/exception-factory.hh>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/liegroup-space.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Decompose a configuration space into elements.
+    struct ConfigurationSampler::ElementVisitor :
+      public boost::static_visitor <>
+    {
+      ElementVisitor (Elements_t& elements, const size_type& nqModel)
+        : elements_ (elements), nqModel_ (nqModel), iq_ (0) {}
+
+      void push (ElementType_t type, const size_type& nq)
+      {
+        Element e; e.type = type; e.iq = iq_; e.nq = nq;
+        // Vector spaces may be merged across the boundary between the model
+        // and the extra configuration space, whose bounds are stored
+        // separately.
+        if (type == VECTOR_SPACE && iq_ < nqModel_ && iq_ + nq > nqModel_) {
+          e.nq = nqModel_ - iq_;
+          elements_.push_back (e);
+          e.iq = nqModel_; e.nq = iq_ + nq - nqModel_;
+        }
+        elements_.push_back (e);
+        iq_ += nq;
+      }
+
+      template <int N, bool rot>
+      void operator () (const liegroup::VectorSpaceOperation<N, rot>& lg)
+      {
+        push (VECTOR_SPACE, lg.nq ());
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<2>&)
+      {
+        push (SO2, 2);
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<3>&)
+      {
+        push (SO3, 4);
+      }
+
+      template <typename LgT1, typename LgT2>
+      void operator () (const liegroup::CartesianProductOperation<LgT1, LgT2>&)
+      {
+        (*this) (LgT1 ());
+        (*this) (LgT2 ());
+      }
+
+      void operator () (const se3::SpecialEuclideanOperation<2>&)
+      {
+        push (VECTOR_SPACE, 2);
+        push (SO2, 2);
+      }
+
+      void operator () (const se3::SpecialEuclideanOperation<3>&)
+      {
+        push (VECTOR_SPACE, 3);
+        push (SO3, 4);
+      }
+
+      Elements_t& elements_;
+      size_type nqModel_, iq_;
+    }; // struct ElementVisitor
+
+    ConfigurationSamplerPtr_t ConfigurationSampler::create
+    (const DevicePtr_t& robot, const unsigned int& seed,
+     const std::size_t& nbStreams)
+    {
+      return ConfigurationSamplerPtr_t
+        (new ConfigurationSampler (robot, seed, nbStreams));
+    }
+
+    ConfigurationSampler::ConfigurationSampler (const DevicePtr_t& robot,
+        const unsigned int& s, const std::size_t& nbStreams)
+      : robot_ (robot), elements_ (), generators_ (nbStreams)
+    {
+      assert (nbStreams > 0);
+      const LiegroupSpacePtr_t& space (robot_->configSpace ());
+      ElementVisitor visitor (elements_, robot_->model ().nq);
+      for (std::size_t i = 0; i < space->liegroupTypes ().size (); ++i)
+        boost::apply_visitor (visitor, space->liegroupTypes () [i]);
+      assert (visitor.iq_ == robot_->configSize ());
+      seed (s);
+    }
+
+    void ConfigurationSampler::seed (const unsigned int& s)
+    {
+      // Each stream is seeded by a master generator so that streams are
+      // not correlated.
+      Generator_t master (s);
+      for (std::size_t i = 0; i < generators_.size (); ++i)
+        generators_ [i].seed (master ());
+    }
+
+    void ConfigurationSampler::sample (ConfigurationOut_t q,
+        const std::size_t& stream)
+    {
+      Eigen::Map<matrix_t> m (q.data (), q.size (), 1);
+      sampleMany (m, stream);
+    }
+
+    void ConfigurationSampler::sampleMany (matrixOut_t qs,
+        const std::size_t& stream)
+    {
+      assert (stream < generators_.size ());
+      assert (qs.rows () == robot_->configSize ());
+      const Model& model (robot_->model ());
+      const ExtraConfigSpace& ecs (robot_->extraConfigSpace ());
+
+      // Generate all the random numbers of the batch at once. Each
+      // coordinate of the output is filled with a raw 32 bits integer,
+      // scaled to [0, 1) in a single array operation, and then mapped to the
+      // corresponding component.
+      Generator_t& gen (generators_ [stream]);
+      for (size_type j = 0; j < qs.cols (); ++j)
+        for (size_type i = 0; i < qs.rows (); ++i)
+          qs (i, j) = value_type (gen ());
+      qs *= value_type (1) / value_type (4294967296.);
+
+      const value_type twoPi (2 * M_PI);
+      for (std::size_t k = 0; k < elements_.size (); ++k) {
+        const Element& e (elements_ [k]);
+        switch (e.type) {
+          case VECTOR_SPACE:
+            {
+              vectorIn_t lower (e.iq < model.nq
+                  ? model.lowerPositionLimit.segment (e.iq, e.nq)
+                  : ecs.lower ().segment (e.iq - model.nq, e.nq));
+              vectorIn_t upper (e.iq < model.nq
+                  ? model.upperPositionLimit.segment (e.iq, e.nq)
+                  : ecs.upper ().segment (e.iq - model.nq, e.nq));
+              if (!lower.allFinite () || !upper.allFinite ())
+                HPP_THROW (std::invalid_argument, "Bounds of coordinates "
+                    << e.iq << " to " << e.iq + e.nq - 1
+                    << " must be finite to sample configurations.");
+              qs.middleRows (e.iq, e.nq).array ()
+                = (qs.middleRows (e.iq, e.nq).array ().colwise ()
+                    * (upper - lower).array ()).colwise () + lower.array ();
+            }
+            break;
+          case SO2:
+            {
+              const Eigen::Array<value_type, 1, Eigen::Dynamic> angle
+                ((twoPi * qs.row (e.iq).array ()) - M_PI);
+              qs.row (e.iq    ).array () = angle.cos ();
+              qs.row (e.iq + 1).array () = angle.sin ();
+            }
+            break;
+          case SO3:
+            {
+              // K. Shoemake, Uniform random rotations, Graphics Gems III.
+              typedef Eigen::Array<value_type, 1, Eigen::Dynamic> Row_t;
+              const Row_t u1 (qs.row (e.iq).array ()),
+                          t2 (twoPi * qs.row (e.iq + 1).array ()),
+                          t3 (twoPi * qs.row (e.iq + 2).array ());
+              const Row_t r1 ((1 - u1).sqrt ()), r2 (u1.sqrt ());
+              qs.row (e.iq    ).array () = r1 * t2.sin ();
+              qs.row (e.iq + 1).array () = r1 * t2.cos ();
+              qs.row (e.iq + 2).array () = r2 * t3.sin ();
+              qs.row (e.iq + 3).array () = r2 * t3.cos ();
+            }
+            break;
+        }
+      }
+    }
+  } // namespace pinocchio
+} // namespace hpp
@@ -39,51 +39,58 @@ namespace hpp {
       configuration.tail(d) = ecs.lower().cwiseMax(configuration.tail(d));
     }
 
+    namespace {
+      /// Accumulate a mask of configuration coordinates into the saturation
+      /// of the corresponding degrees of freedom.
+      /// \param offset rank of the first coordinate of mask in configurations.
+      template <typename Mask>
+      inline bool accumulateMask (const Eigen::ArrayBase<Mask>& mask,
+                                  const std::vector<size_type>& qToV,
+                                  const size_type& offset,
+                                  ArrayXb& saturation)
+      {
+        // The mask is a lazy expression: each coefficient is computed
+        // once by the loop, without temporary.
+        for (size_type i = 0; i < mask.size(); ++i)
+          saturation[qToV[offset + i]] |= mask.coeff(i);
+        return saturation.any();
+      }
+
+      /// Accumulate into saturation the coordinates of q out of bounds.
+      inline bool saturationMask (ConfigurationIn_t q,
+                                  vectorIn_t lower, vectorIn_t upper,
+                                  const std::vector<size_type>& qToV,
+                                  const size_type& offset,
+                                  ArrayXb& saturation)
+      {
+        if (q.size() == 0) return false;
+        return accumulateMask ((q.array() > upper.array())
+                               || (q.array() < lower.array()),
+                               qToV, offset, saturation);
+      }
+    }
+
     bool saturate (const DevicePtr_t& robot,
                    ConfigurationOut_t configuration,
                    ArrayXb& saturation)
     {
-      bool ret = false;
       const se3::Model& model = robot->model();
-
-      for (std::size_t i = 1; i < model.joints.size(); ++i) {
-        const size_type nq = model.joints[i].nq();
-        const size_type nv = model.joints[i].nv();
-        const size_type idx_q = model.joints[i].idx_q();
-        const size_type idx_v = model.joints[i].idx_v();
-        for (size_type j = 0; j < nq; ++j) {
-          const size_type iq = idx_q + j;
-          const size_type iv = idx_v + std::min(j,nv-1);
-          if        (configuration[iq] > model.upperPositionLimit[iq]) {
-            saturation[iv] = true;
-            configuration[iq] = model.upperPositionLimit[iq];
-            ret = true;
-          } else if (configuration[iq] < model.lowerPositionLimit[iq]) {
-            saturation[iv] = true;
-            configuration[iq] = model.lowerPositionLimit[iq];
-            ret = true;
-          } else
-            saturation[iv] = false;
-        }
-      }
-
       const ExtraConfigSpace& ecs = robot->extraConfigSpace();
       const size_type& d = ecs.dimension();
+      const std::vector<size_type>& qToV = robot->configToVelocityIndex();
+      assert (saturation.size() == robot->numberDof());
+      assert (size_type(qToV.size()) == robot->configSize());
 
-      for (size_type k = 0; k < d; ++k) {
-        const size_type iq = model.nq + k;
-        const size_type iv = model.nv + k;
-        if        (configuration[iq] > ecs.upper(k)) {
-          saturation[iv] = true;
-          configuration[iq] = ecs.upper(k);
-          ret = true;
-        } else if (configuration[iq] < ecs.lower(k)) {
-          saturation[iv] = true;
-          configuration[iq] = ecs.lower(k);
-          ret = true;
-        } else
-          saturation[iv] = false;
-      }
+      // Coordinates of a same degree of freedom (e.g. the quaternion of
+      // SO(3) joints) are merged with a logical or.
+      saturation.setConstant (false);
+      bool ret = saturationMask (configuration.head(model.nq),
+          model.lowerPositionLimit, model.upperPositionLimit, qToV, 0,
+          saturation);
+      ret = saturationMask (configuration.tail(d), ecs.lower(), ecs.upper(),
+          qToV, model.nq, saturation) || ret;
+
+      saturate (robot, configuration);
       return ret;
     }
 
@@ -178,6 +185,10 @@ namespace hpp {
 						   ConfigurationIn_t q1,
 						   ConfigurationIn_t q2,
 						   vectorOut_t result);
+    template void difference <LieGroupTpl> (const DevicePtr_t& robot,
+					    ConfigurationIn_t q1,
+					    ConfigurationIn_t q2,
+					    vectorOut_t result);
     // TODO remove me. This is kept for backward compatibility
     template void difference <se3::LieGroupTpl> (const DevicePtr_t& robot,
 						 ConfigurationIn_t q1,
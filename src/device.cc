@@ -19,10 +19,21 @@
 
 #include <hpp/pinocchio/device.hh>
 
+#include <algorithm>
+#include <limits>
+
 #include <boost/foreach.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <Eigen/Core>
+#include <Eigen/Eigenvalues>
 
 #include <hpp/fcl/BV/AABB.h>
+#include <hpp/fcl/BV/OBBRSS.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
 
 #include <pinocchio/multibody/model.hpp>
 #include <pinocchio/algorithm/center-of-mass.hpp>
@@ -31,6 +42,7 @@
 #include <pinocchio/algorithm/kinematics.hpp>
 #include <pinocchio/algorithm/geometry.hpp>
 #include <pinocchio/algorithm/joint-configuration.hpp> // se3::details::Dispatch
+#include <pinocchio/spatial/fcl-pinocchio-conversions.hpp>
 
 #include <hpp/pinocchio/fwd.hh>
 //#include <hpp/pinocchio/distance-result.hh>
@@ -44,12 +56,167 @@
 namespace hpp {
   namespace pinocchio {
 
+    /// Geometries added by a loader, possibly in a separate thread.
+    struct Device::DeferredGeometry
+    {
+      GeometryLoader_t loader;
+      GeomModel geomModel;
+      boost::exception_ptr error;
+      boost::shared_ptr<boost::thread> thread;
+
+      DeferredGeometry (const GeometryLoader_t& l) : loader (l) {}
+
+      ~DeferredGeometry ()
+      {
+        // The thread writes into this object.
+        if (thread) thread->join();
+      }
+
+      void run ()
+      {
+        try {
+          loader (geomModel);
+        } catch (...) {
+          error = boost::current_exception();
+        }
+      }
+
+      void start ()
+      {
+        thread.reset (new boost::thread (&DeferredGeometry::run, this));
+      }
+
+      void wait ()
+      {
+        if (thread) {
+          thread->join();
+          thread.reset();
+        } else
+          run();
+      }
+    };
+
+    /// Convex approximations of the geometries of a device
+    struct Device::CollisionProxies
+    {
+      typedef boost::shared_ptr<fcl::CollisionGeometry> CollisionGeometryPtr_t;
+      typedef fcl::BVHModel<fcl::OBBRSS> Polyhedron_t;
+
+      struct Proxy
+      {
+        /// Empty if the geometry has no proxy.
+        CollisionGeometryPtr_t geometry;
+        /// Placement of the proxy in the frame of the geometry
+        Transform3f placement;
+        /// Whether the proxy is the geometry itself.
+        bool exact;
+      };
+      std::vector<Proxy> proxies;
+
+      CollisionProxies (const GeomModel& geomModel)
+        : proxies (geomModel.geometryObjects.size())
+      {
+        for (std::size_t i = 0; i < proxies.size(); ++i)
+          {
+            const CollisionGeometryPtr_t& g (geomModel.geometryObjects[i].fcl);
+            Proxy& p (proxies[i]);
+            p.placement.setIdentity();
+            p.exact = (g->getObjectType() == fcl::OT_GEOM);
+            if (p.exact) {
+              p.geometry = g;
+              continue;
+            }
+            const Polyhedron_t* mesh = dynamic_cast<const Polyhedron_t*> (g.get());
+            if (mesh == NULL || mesh->num_vertices == 0) continue;
+            boundingBox (*mesh, p);
+          }
+      }
+
+      /// Oriented bounding box along the principal axes of the vertices
+      static void boundingBox (const Polyhedron_t& mesh, Proxy& p)
+      {
+        const int n = mesh.num_vertices;
+        std::vector<vector3_t> vertices (n);
+        vector3_t mean (vector3_t::Zero());
+        for (int k = 0; k < n; ++k) {
+          const fcl::Vec3f& v (mesh.vertices[k]);
+          vertices[k] = vector3_t (v[0], v[1], v[2]);
+          mean += vertices[k];
+        }
+        mean /= n;
+        matrix3_t covariance (matrix3_t::Zero());
+        for (int k = 0; k < n; ++k)
+          covariance += (vertices[k] - mean) * (vertices[k] - mean).transpose();
+
+        Eigen::SelfAdjointEigenSolver<matrix3_t> eigen (covariance);
+        matrix3_t R (eigen.eigenvectors());
+        if (R.determinant() < 0) R.col(2) *= -1;
+
+        vector3_t lower (vector3_t::Constant(+std::numeric_limits<value_type>::infinity())),
+                  upper (vector3_t::Constant(-std::numeric_limits<value_type>::infinity()));
+        for (int k = 0; k < n; ++k) {
+          const vector3_t x (R.transpose() * (vertices[k] - mean));
+          lower = lower.cwiseMin (x);
+          upper = upper.cwiseMax (x);
+        }
+        const vector3_t size (upper - lower);
+        p.geometry.reset (new fcl::Box (size[0], size[1], size[2]));
+        p.placement = Transform3f (R, mean + R * (lower + upper) / 2);
+      }
+
+      fcl::Transform3f transform (const std::size_t& i, const GeomData& geomData) const
+      {
+        return se3::toFclTransform3f (geomData.oMg[i] * proxies[i].placement);
+      }
+
+      bool exact (const se3::CollisionPair& pair) const
+      {
+        return proxies[pair.first].exact && proxies[pair.second].exact;
+      }
+
+      /// Test collision between the proxies of a pair
+      /// \return true if the proxies collide or if one of the objects has
+      ///         no proxy.
+      bool collide (const se3::CollisionPair& pair, const GeomData& geomData,
+                    fcl::CollisionResult& result) const
+      {
+        result.clear();
+        const Proxy& p1 (proxies[pair.first ]);
+        const Proxy& p2 (proxies[pair.second]);
+        if (!p1.geometry || !p2.geometry) return true;
+        fcl::collide (p1.geometry.get(), transform (pair.first , geomData),
+                      p2.geometry.get(), transform (pair.second, geomData),
+                      geomData.collisionRequest, result);
+        return result.isCollision();
+      }
+
+      /// Distance between the proxies of a pair
+      /// \return 0 if the proxies collide or if one of the objects has no
+      ///         proxy.
+      value_type distance (const se3::CollisionPair& pair,
+                           const GeomData& geomData) const
+      {
+        const Proxy& p1 (proxies[pair.first ]);
+        const Proxy& p2 (proxies[pair.second]);
+        if (!p1.geometry || !p2.geometry) return 0;
+        fcl::DistanceRequest request;
+        fcl::DistanceResult result;
+        fcl::distance (p1.geometry.get(), transform (pair.first , geomData),
+                       p2.geometry.get(), transform (pair.second, geomData),
+                       request, result);
+        return std::max (value_type(0), value_type(result.min_distance));
+      }
+    };
+
     Device::
     Device(const std::string& name)
       : model_(new Model())
       , data_ ()
       , geomModel_(new GeomModel())
       , geomData_ ()
+      , loadingDeferredGeometry_ (false)
+      , geometryLoaded_ (true)
+      , useCollisionProxies_ (false)
       , name_ (name)
       , jointVector_()
       , computationFlag_ (Computation_t(JOINT_POSITION | JACOBIAN))
@@ -67,6 +234,10 @@ namespace hpp {
       , data_ (new Data (other.data()))
       , geomModel_(other.geomModel_)
       , geomData_ (new GeomData (other.geomData()))
+      , loadingDeferredGeometry_ (false)
+      , geometryLoaded_ (true)
+      , collisionProxies_ (other.collisionProxies_)
+      , useCollisionProxies_ (other.useCollisionProxies_)
       , name_ (other.name_)
       , jointVector_()
       , currentConfiguration_ (other.currentConfiguration_)
@@ -79,6 +250,7 @@ namespace hpp {
       , obstacles_()
       , objectVector_ ()
       , grippers_ ()
+      , configToVelocityIndex_ (other.configToVelocityIndex_)
       , extraConfigSpace_ (other.extraConfigSpace_)
       , weakPtr_()
     {
@@ -144,8 +316,82 @@ namespace hpp {
     {
       geomData_ = GeomDataPtr_t( new GeomData(*geomModel_) );
       se3::computeBodyRadius(*model_,*geomModel_,*geomData_);
+      collisionProxies_.reset();
       invalidate();
     }
+
+    const Device::CollisionProxies& Device::
+    collisionProxies ()
+    {
+      // Load the deferred geometries, which resets the proxies.
+      const GeomModel& gm = geomModel();
+      // Geometries may also have been added to the model directly.
+      if (!collisionProxies_ ||
+          collisionProxies_->proxies.size() != gm.geometryObjects.size())
+        collisionProxies_.reset (new CollisionProxies (gm));
+      return *collisionProxies_;
+    }
+
+    void Device::
+    deferGeometry (const GeometryLoader_t& loader, bool background)
+    {
+      DeferredGeometryPtr_t deferred (new DeferredGeometry (loader));
+      if (background) deferred->start();
+      boost::recursive_mutex::scoped_lock lock (deferredGeometryMutex_);
+      deferredGeometry_.push_back (deferred);
+      geometryLoaded_.store (false, boost::memory_order_release);
+    }
+
+    /// Mark the deferred geometries as loaded when leaving
+    /// appendDeferredGeometry, even by an exception.
+    struct Device::LoadingGuard
+    {
+      const Device& device;
+
+      LoadingGuard (const Device& d) : device (d)
+      {
+        device.loadingDeferredGeometry_ = true;
+      }
+
+      ~LoadingGuard ()
+      {
+        device.loadingDeferredGeometry_ = false;
+        device.geometryLoaded_.store (device.deferredGeometry_.empty(),
+                                      boost::memory_order_release);
+      }
+    };
+
+    void Device::
+    appendDeferredGeometry () const
+    {
+      boost::recursive_mutex::scoped_lock lock (deferredGeometryMutex_);
+      // Either another thread loaded the geometries while this one was
+      // waiting for the lock, or this thread is loading them and calls
+      // the accessors below.
+      if (geometryLoaded_.load (boost::memory_order_relaxed)
+          || loadingDeferredGeometry_) return;
+
+      // Other threads wait for the lock until the guard publishes the
+      // geometries. Each loader is used once, even if an exception is
+      // thrown below.
+      std::vector<DeferredGeometryPtr_t> deferred;
+      deferred.swap (deferredGeometry_);
+      LoadingGuard guard (*this);
+
+      boost::exception_ptr error;
+      BOOST_FOREACH (const DeferredGeometryPtr_t& d, deferred)
+        {
+          d->wait();
+          if (d->error) {
+            if (!error) error = d->error;
+            continue;
+          }
+          se3::appendGeometryModel(*geomModel_, d->geomModel);
+        }
+      const_cast<Device*>(this)->createGeomData();
+      hppDout (info, "Loaded deferred geometries of " << name_);
+      if (error) boost::rethrow_exception (error);
+    }
     
     /* ---------------------------------------------------------------------- */
     /* --- JOINT ------------------------------------------------------------ */
@@ -300,6 +546,17 @@ namespace hpp {
         ConfigSpaceVisitor::run(m.joints[i], args);
       if (extraConfigSpace_.dimension() > 0)
         *configSpace_ *= LiegroupSpace::create (extraConfigSpace_.dimension());
+      configSpace_ = LiegroupSpace::canonical (configSpace_);
+
+      configToVelocityIndex_.resize (configSize());
+      for (JointIndex i = 1; i < m.joints.size(); ++i) {
+        const size_type nq = m.joints[i].nq(), nv = m.joints[i].nv(),
+                        idx_q = m.joints[i].idx_q(), idx_v = m.joints[i].idx_v();
+        for (size_type j = 0; j < nq; ++j)
+          configToVelocityIndex_[idx_q + j] = idx_v + std::min(j, nv - 1);
+      }
+      for (size_type k = 0; k < extraConfigSpace_.dimension(); ++k)
+        configToVelocityIndex_[m.nq + k] = m.nv + k;
     }
 
     bool Device::
@@ -430,7 +687,31 @@ namespace hpp {
       /* Following hpp::model API, the forward kinematics (joint placement) is
        * supposed to have already been computed. */
       updateGeometryPlacements();
-      return se3::computeCollisions(geomModel(), geomData(),stopAtFirstCollision);
+      if (!useCollisionProxies_)
+        return se3::computeCollisions(geomModel(), geomData(),stopAtFirstCollision);
+
+      const CollisionProxies& proxies (collisionProxies());
+      const GeomModel& gm (geomModel());
+      GeomData& gd (geomData());
+      bool isColliding = false;
+      for (std::size_t cp = 0; cp < gm.collisionPairs.size(); ++cp)
+        {
+          if (!gd.activeCollisionPairs[cp]) continue;
+          const se3::CollisionPair& pair (gm.collisionPairs[cp]);
+          if (!proxies.collide (pair, gd, gd.collisionResults[cp])) continue;
+          if (!proxies.exact (pair)) se3::computeCollision (gm, gd, cp);
+          isColliding |= gd.collisionResults[cp].isCollision();
+          if (isColliding && stopAtFirstCollision) return true;
+        }
+      return isColliding;
+    }
+
+    value_type Device::distanceLowerBound (const std::size_t& pairIndex)
+    {
+      updateGeometryPlacements();
+      const CollisionProxies& proxies (collisionProxies());
+      return proxies.distance (geomModel().collisionPairs[pairIndex],
+                               geomData());
     }
 
     void Device::computeDistances ()
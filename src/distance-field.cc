@@ -0,0 +1,534 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "hpp/pinocchio/distance-field.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <hpp/fcl/BV/OBBRSS.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/collision.h>
+
+#include <pinocchio/multibody/geometry.hpp>
+#include <pinocchio/spatial/fcl-pinocchio-conversions.hpp>
+
+#include <hpp/util/debug.hh>
+#include <hpp/util/exception-factory.hh>
+
+#include "hpp/pinocchio/device.hh"
+#include "hpp/pinocchio/sphere-approximation.hh"
+
+#include "bounding-sphere.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    using details::toVector3;
+
+    namespace {
+      typedef fcl::BVHModel<fcl::OBBRSS> Polyhedron_t;
+      typedef boost::uint64_t uint64;
+      typedef boost::uint32_t uint32;
+
+      const char magic[8] = { 'H', 'P', 'P', 'S', 'D', 'F', 0, 0 };
+      const uint32 version = 2;
+
+      /// Squared Euclidean distance transform of a line of a grid
+      ///
+      /// This is the algorithm of Felzenszwalb and Huttenlocher,
+      /// Distance Transforms of Sampled Functions, 2012.
+      struct DistanceTransform
+      {
+        std::vector<value_type> f, z;
+        std::vector<size_type> v;
+
+        /// Intersection of the parabolas rooted at q and p
+        value_type intersection (const size_type& q, const size_type& p) const
+        {
+          return ((f[q] + value_type(q*q)) - (f[p] + value_type(p*p)))
+            / value_type(2*(q - p));
+        }
+
+        void operator() (value_type* data, const size_type& n,
+                         const size_type& stride)
+        {
+          f.resize (n); v.resize (n); z.resize (n + 1);
+          for (size_type q = 0; q < n; ++q) f[q] = data[q * stride];
+
+          size_type k = 0;
+          v[0] = 0;
+          z[0] = -std::numeric_limits<value_type>::infinity();
+          z[1] = +std::numeric_limits<value_type>::infinity();
+          for (size_type q = 1; q < n; ++q) {
+            // As z[0] is -infinity, the loop stops at k = 0.
+            value_type s = intersection (q, v[k]);
+            while (s <= z[k]) {
+              --k;
+              s = intersection (q, v[k]);
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k+1] = +std::numeric_limits<value_type>::infinity();
+          }
+
+          k = 0;
+          for (size_type q = 0; q < n; ++q) {
+            while (z[k+1] < value_type(q)) ++k;
+            const size_type p = v[k];
+            data[q * stride] = value_type((q-p)*(q-p)) + f[p];
+          }
+        }
+      }; // struct DistanceTransform
+
+      /// Squared Euclidean distance transform of a grid, in place
+      void distanceTransform (vector_t& grid,
+                              const DistanceField::Dimensions_t& dims)
+      {
+        DistanceTransform transform;
+        size_type stride = 1;
+        for (int a = 0; a < 3; ++a) {
+          for (size_type i = 0; i < grid.size(); ++i)
+            // First voxel of a line along axis a
+            if ((i / stride) % dims[a] == 0)
+              transform (grid.data() + i, dims[a], stride);
+          stride *= dims[a];
+        }
+      }
+
+      /// Set the free voxels of a box that are connected to its boundary
+      /// to 2.
+      /// \param voxels 1 if occupied, 0 if free, x varying fastest.
+      void floodFill (std::vector<char>& voxels,
+                      const DistanceField::Dimensions_t& dims)
+      {
+        const size_type n (dims.prod());
+        const size_type strides[3] = { 1, dims[0], dims[0] * dims[1] };
+        std::vector<size_type> stack;
+        for (size_type v = 0; v < n; ++v) {
+          if (voxels[v] != 0) continue;
+          bool boundary = false;
+          for (int d = 0; d < 3; ++d) {
+            const size_type c ((v / strides[d]) % dims[d]);
+            boundary = boundary || c == 0 || c == dims[d] - 1;
+          }
+          if (!boundary) continue;
+          voxels[v] = 2;
+          stack.push_back (v);
+        }
+        while (!stack.empty()) {
+          const size_type v (stack.back());
+          stack.pop_back();
+          for (int d = 0; d < 3; ++d) {
+            const size_type c ((v / strides[d]) % dims[d]);
+            if (c > 0 && voxels[v - strides[d]] == 0) {
+              voxels[v - strides[d]] = 2;
+              stack.push_back (v - strides[d]);
+            }
+            if (c < dims[d] - 1 && voxels[v + strides[d]] == 0) {
+              voxels[v + strides[d]] = 2;
+              stack.push_back (v + strides[d]);
+            }
+          }
+        }
+      }
+
+      /// Add the shape of a geometry to a hash
+      void hashGeometry (std::size_t& key, const fcl::CollisionGeometry& g)
+      {
+        boost::hash_combine (key, int (g.getNodeType()));
+        switch (g.getNodeType()) {
+          case fcl::GEOM_BOX: {
+            const fcl::Vec3f& s (static_cast<const fcl::Box&> (g).side);
+            for (int d = 0; d < 3; ++d) boost::hash_combine (key, s[d]);
+            return;
+          }
+          case fcl::GEOM_SPHERE:
+            boost::hash_combine (key,
+                                 static_cast<const fcl::Sphere&> (g).radius);
+            return;
+          case fcl::GEOM_CAPSULE: {
+            const fcl::Capsule& c (static_cast<const fcl::Capsule&> (g));
+            boost::hash_combine (key, c.radius);
+            boost::hash_combine (key, c.lz);
+            return;
+          }
+          case fcl::GEOM_CONE: {
+            const fcl::Cone& c (static_cast<const fcl::Cone&> (g));
+            boost::hash_combine (key, c.radius);
+            boost::hash_combine (key, c.lz);
+            return;
+          }
+          case fcl::GEOM_CYLINDER: {
+            const fcl::Cylinder& c (static_cast<const fcl::Cylinder&> (g));
+            boost::hash_combine (key, c.radius);
+            boost::hash_combine (key, c.lz);
+            return;
+          }
+          default:
+            break;
+        }
+        const Polyhedron_t* mesh = dynamic_cast<const Polyhedron_t*> (&g);
+        if (mesh == NULL) return;
+        for (int k = 0; k < mesh->num_vertices; ++k)
+          for (int d = 0; d < 3; ++d)
+            boost::hash_combine (key, mesh->vertices[k][d]);
+        for (int k = 0; k < mesh->num_tris; ++k)
+          for (int d = 0; d < 3; ++d)
+            boost::hash_combine (key, mesh->tri_indices[k][d]);
+      }
+
+      /// Hash of the names, placements and shapes of the obstacles
+      std::size_t obstacleKey (const GeomModel& geomModel)
+      {
+        std::size_t key = 0;
+        for (std::size_t i = 0; i < geomModel.geometryObjects.size(); ++i)
+          {
+            const se3::GeometryObject& go (geomModel.geometryObjects[i]);
+            if (go.parentJoint != 0) continue;
+            boost::hash_combine (key, go.name);
+            for (int r = 0; r < 3; ++r) {
+              for (int c = 0; c < 3; ++c)
+                boost::hash_combine (key, go.placement.rotation()(r, c));
+              boost::hash_combine (key, go.placement.translation()[r]);
+            }
+            hashGeometry (key, *go.fcl);
+          }
+        return key;
+      }
+
+      /// Whether a grid is not larger than DistanceField::MaxVoxels
+      bool validDimensions (const value_type dims[3])
+      {
+        value_type n (1);
+        for (int d = 0; d < 3; ++d) n *= dims[d];
+        return n <= value_type (DistanceField::MaxVoxels);
+      }
+
+      template <typename T> void write (std::ostream& os, const T& t)
+      {
+        os.write (reinterpret_cast <const char*> (&t), sizeof (T));
+      }
+
+      template <typename T> bool read (std::istream& is, T& t)
+      {
+        return (bool) is.read (reinterpret_cast <char*> (&t), sizeof (T));
+      }
+    } // namespace
+
+    const size_type DistanceField::MaxVoxels = size_type (1) << 27;
+
+    DistanceField::DistanceField () :
+      origin_ (vector3_t::Zero()), resolution_ (0),
+      dimensions_ (Dimensions_t::Zero()), values_ (), key_ (0),
+      meshesFilled_ (false)
+    {}
+
+    DistanceFieldPtr_t DistanceField::create (const DevicePtr_t& device,
+                                              const value_type& resolution,
+                                              const value_type& margin,
+                                              const bool& fillMeshes)
+    {
+      if (resolution <= 0)
+        HPP_THROW (std::invalid_argument, "Invalid resolution " << resolution);
+      DistanceFieldPtr_t field (new DistanceField);
+      field->resolution_ = resolution;
+      field->meshesFilled_ = fillMeshes;
+      field->build (device->geomModel(), margin);
+      return field;
+    }
+
+    void DistanceField::build (const GeomModel& geomModel,
+                               const value_type& margin)
+    {
+      const value_type inf (std::numeric_limits<value_type>::infinity());
+
+      // Obstacles and their bounding boxes
+      std::vector<std::size_t> obstacles;
+      std::vector<vector3_t> lowers, uppers;
+      vector3_t lower (vector3_t::Constant (+inf)),
+                upper (vector3_t::Constant (-inf));
+      for (std::size_t i = 0; i < geomModel.geometryObjects.size(); ++i)
+        {
+          const se3::GeometryObject& go (geomModel.geometryObjects[i]);
+          if (go.parentJoint != 0) continue;
+          const Transform3f& M (go.placement);
+          vector3_t l (vector3_t::Constant (+inf)),
+                    u (vector3_t::Constant (-inf));
+          const value_type radius (details::primitiveRadius (*go.fcl));
+          if (radius >= 0) {
+            l = M.translation().array() - radius;
+            u = M.translation().array() + radius;
+          } else {
+            const Polyhedron_t* mesh =
+              dynamic_cast<const Polyhedron_t*> (go.fcl.get());
+            if (mesh == NULL || mesh->num_vertices == 0) {
+              hppDout (warning, "Obstacle " << go.name
+                  << " is not in the distance field.");
+              continue;
+            }
+            for (int k = 0; k < mesh->num_vertices; ++k) {
+              const vector3_t x (M.act (toVector3 (mesh->vertices[k])));
+              l = l.cwiseMin (x);
+              u = u.cwiseMax (x);
+            }
+          }
+          obstacles.push_back (i);
+          lowers.push_back (l);
+          uppers.push_back (u);
+          lower = lower.cwiseMin (l);
+          upper = upper.cwiseMax (u);
+        }
+      if (obstacles.empty())
+        throw std::invalid_argument ("The device has no obstacle.");
+
+      origin_ = lower.array() - margin;
+      value_type dims[3];
+      for (int d = 0; d < 3; ++d)
+        dims[d] = std::max (value_type (2), std::ceil
+            ((upper[d] - lower[d] + 2 * margin) / resolution_) + 1);
+      if (!validDimensions (dims))
+        HPP_THROW (std::invalid_argument, "A distance field of resolution "
+            << resolution_ << " would have " << dims[0] << "x" << dims[1]
+            << "x" << dims[2] << " voxels, more than " << MaxVoxels << ".");
+      for (int d = 0; d < 3; ++d) dimensions_[d] = size_type (dims[d]);
+      const size_type n (dimensions_.prod());
+
+      // Occupied voxels
+      std::vector<bool> occupied (n, false);
+      const fcl::Box voxel (resolution_, resolution_, resolution_);
+      const fcl::CollisionRequest request;
+      std::vector<char> inBox;
+      for (std::size_t o = 0; o < obstacles.size(); ++o)
+        {
+          const se3::GeometryObject& go
+            (geomModel.geometryObjects[obstacles[o]]);
+          const fcl::Transform3f tf (se3::toFclTransform3f (go.placement));
+          // Meshes are surfaces. When they are filled, their interior is
+          // made of the free voxels that cannot be reached from the boundary
+          // of a box one voxel larger than their bounding box.
+          const bool fill (meshesFilled_
+              && details::primitiveRadius (*go.fcl) < 0);
+          Dimensions_t first, last, boxFirst, boxDims;
+          for (int d = 0; d < 3; ++d) {
+            boxFirst[d] = size_type (std::floor
+                ((lowers[o][d] - origin_[d]) / resolution_)) - 1;
+            boxDims[d] = size_type (std::ceil
+                ((uppers[o][d] - origin_[d]) / resolution_)) + 2 - boxFirst[d];
+            first[d] = std::max (size_type (0), boxFirst[d] + 1);
+            last [d] = std::min (dimensions_[d] - 1,
+                                 boxFirst[d] + boxDims[d] - 2);
+          }
+          if (fill) inBox.assign (boxDims.prod(), 0);
+          for (size_type k = first[2]; k <= last[2]; ++k)
+            for (size_type j = first[1]; j <= last[1]; ++j)
+              for (size_type i = first[0]; i <= last[0]; ++i)
+                {
+                  const size_type v (index (i, j, k));
+                  if (occupied[v] && !fill) continue;
+                  const vector3_t center (origin_
+                      + resolution_ * vector3_t (value_type(i), value_type(j),
+                                                 value_type(k)));
+                  fcl::CollisionResult result;
+                  fcl::collide (&voxel, se3::toFclTransform3f (Transform3f
+                        (matrix3_t::Identity(), center)),
+                      go.fcl.get(), tf, request, result);
+                  if (!result.isCollision()) continue;
+                  occupied[v] = true;
+                  if (fill)
+                    inBox[(i - boxFirst[0]) + boxDims[0] * ((j - boxFirst[1])
+                          + boxDims[1] * (k - boxFirst[2]))] = 1;
+                }
+          if (!fill) continue;
+          floodFill (inBox, boxDims);
+          for (size_type v = 0; v < size_type (inBox.size()); ++v) {
+            if (inBox[v] != 0) continue;
+            const size_type i (boxFirst[0] + v % boxDims[0]),
+                            j (boxFirst[1] + (v / boxDims[0]) % boxDims[1]),
+                            k (boxFirst[2] + v / (boxDims[0] * boxDims[1]));
+            if (i >= 0 && i < dimensions_[0] && j >= 0 && j < dimensions_[1]
+                && k >= 0 && k < dimensions_[2])
+              occupied[index (i, j, k)] = true;
+          }
+        }
+
+      // Distances to the nearest occupied and free voxels. The initial
+      // squared distance of the other voxels is larger than the diagonal of
+      // the grid, and finite so that differences of values are exact.
+      const value_type far (4 * value_type (dimensions_.sum() * dimensions_.sum()));
+      vector_t outside (n), inside (n);
+      for (size_type v = 0; v < n; ++v) {
+        outside[v] = (occupied[v] ? 0 : far);
+        inside [v] = (occupied[v] ? far : 0);
+      }
+      distanceTransform (outside, dimensions_);
+      distanceTransform (inside , dimensions_);
+
+      values_.resize (n);
+      for (size_type v = 0; v < n; ++v) {
+        if (occupied[v])
+          values_[v] = - resolution_ * (std::sqrt (inside[v]) - .5);
+        else
+          values_[v] =   resolution_ * (std::sqrt (outside[v]) - .5);
+      }
+      key_ = obstacleKey (geomModel);
+      hppDout (info, "Distance field of " << obstacles.size()
+          << " obstacles with " << dimensions_.transpose() << " voxels.");
+    }
+
+    value_type DistanceField::distance (const vector3_t& point) const
+    {
+      vector3_t gradient;
+      return distance (point, gradient);
+    }
+
+    value_type DistanceField::distance (const vector3_t& point,
+                                        vector3_t& gradient) const
+    {
+      // Coordinates in the grid, clamped to the grid.
+      const vector3_t u ((point - origin_) / resolution_);
+      vector3_t c, f;
+      Dimensions_t i0;
+      for (int d = 0; d < 3; ++d) {
+        c[d] = std::min (std::max (u[d], value_type (0)),
+                         value_type (dimensions_[d] - 1));
+        i0[d] = std::min (size_type (std::floor (c[d])), dimensions_[d] - 2);
+        f[d] = c[d] - value_type (i0[d]);
+      }
+
+      value_type v[2][2][2];
+      for (int a = 0; a < 2; ++a)
+        for (int b = 0; b < 2; ++b)
+          for (int e = 0; e < 2; ++e)
+            v[a][b][e] = values_[index (i0[0]+a, i0[1]+b, i0[2]+e)];
+
+      // Trilinear interpolation
+      const value_type gx = 1 - f[0], gy = 1 - f[1], gz = 1 - f[2];
+      value_type value =
+          gx   * (gy   * (gz * v[0][0][0] + f[2] * v[0][0][1])
+                + f[1] * (gz * v[0][1][0] + f[2] * v[0][1][1]))
+        + f[0] * (gy   * (gz * v[1][0][0] + f[2] * v[1][0][1])
+                + f[1] * (gz * v[1][1][0] + f[2] * v[1][1][1]));
+      gradient[0] =
+          gy   * (gz * (v[1][0][0] - v[0][0][0]) + f[2] * (v[1][0][1] - v[0][0][1]))
+        + f[1] * (gz * (v[1][1][0] - v[0][1][0]) + f[2] * (v[1][1][1] - v[0][1][1]));
+      gradient[1] =
+          gx   * (gz * (v[0][1][0] - v[0][0][0]) + f[2] * (v[0][1][1] - v[0][0][1]))
+        + f[0] * (gz * (v[1][1][0] - v[1][0][0]) + f[2] * (v[1][1][1] - v[1][0][1]));
+      gradient[2] =
+          gx   * (gy * (v[0][0][1] - v[0][0][0]) + f[1] * (v[0][1][1] - v[0][1][0]))
+        + f[0] * (gy * (v[1][0][1] - v[1][0][0]) + f[1] * (v[1][1][1] - v[1][1][0]));
+      gradient /= resolution_;
+
+      // Points outside of the grid
+      const vector3_t outside ((u - c) * resolution_);
+      const value_type d (outside.norm());
+      if (d > 0) {
+        for (int k = 0; k < 3; ++k)
+          if (u[k] != c[k]) gradient[k] = 0;
+        gradient += outside / d;
+        value += d;
+      }
+      return value;
+    }
+
+    void DistanceField::distances (const SphereApproximation& spheres,
+                                   vector_t& distances) const
+    {
+      distances.resize (spheres.size());
+      for (size_type k = 0; k < spheres.size(); ++k)
+        distances[k] = distance (vector3_t (spheres.centers().col(k)))
+          - spheres.radii()[k];
+    }
+
+    void DistanceField::save (const std::string& filename) const
+    {
+      std::ofstream os (filename.c_str(), std::ios::binary);
+      if (!os)
+        throw std::invalid_argument ("Unable to write " + filename);
+      os.write (magic, sizeof (magic));
+      write (os, version);
+      write (os, uint32 (meshesFilled_ ? 1 : 0));
+      write (os, uint64 (key_));
+      for (int d = 0; d < 3; ++d) write (os, double (origin_[d]));
+      write (os, double (resolution_));
+      for (int d = 0; d < 3; ++d) write (os, uint64 (dimensions_[d]));
+      for (size_type v = 0; v < values_.size(); ++v)
+        write (os, double (values_[v]));
+      if (!os)
+        throw std::invalid_argument ("Unable to write " + filename);
+    }
+
+    DistanceFieldPtr_t DistanceField::load (const std::string& filename)
+    {
+      std::ifstream is (filename.c_str(), std::ios::binary);
+      if (!is)
+        throw std::invalid_argument ("Unable to read " + filename);
+
+      char m[8];
+      uint32 ver, flags;
+      uint64 key;
+      double origin[3], resolution;
+      uint64 dims[3];
+      value_type dimensions[3];
+      bool ok = (bool) is.read (m, sizeof (m))
+        && std::memcmp (m, magic, sizeof (magic)) == 0
+        && read (is, ver) && ver == version && read (is, flags)
+        && read (is, key);
+      for (int d = 0; ok && d < 3; ++d) ok = read (is, origin[d]);
+      ok = ok && read (is, resolution) && resolution > 0;
+      for (int d = 0; ok && d < 3; ++d) {
+        ok = read (is, dims[d]) && dims[d] >= 2;
+        dimensions[d] = value_type (dims[d]);
+      }
+      if (!ok)
+        throw std::invalid_argument (filename + " is not a distance field");
+      if (!validDimensions (dimensions))
+        HPP_THROW (std::invalid_argument, filename << " has " << dims[0]
+            << "x" << dims[1] << "x" << dims[2] << " voxels, more than "
+            << MaxVoxels << ".");
+
+      DistanceFieldPtr_t field (new DistanceField);
+      field->key_ = std::size_t (key);
+      field->meshesFilled_ = (flags & 1) != 0;
+      field->origin_ = vector3_t (origin[0], origin[1], origin[2]);
+      field->resolution_ = resolution;
+      field->dimensions_ = Dimensions_t (size_type (dims[0]),
+          size_type (dims[1]), size_type (dims[2]));
+      field->values_.resize (field->dimensions_.prod());
+      for (size_type v = 0; ok && v < field->values_.size(); ++v) {
+        double value;
+        ok = read (is, value);
+        field->values_[v] = value;
+      }
+      if (!ok)
+        throw std::invalid_argument (filename + " is not a distance field");
+      return field;
+    }
+
+    bool DistanceField::matches (const DevicePtr_t& device) const
+    {
+      return key_ == obstacleKey (device->geomModel());
+    }
+  }  //  namespace pinocchio
+}  //  namespace hpp
@@ -0,0 +1,82 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/geodesic-segment.hh>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    template <typename LieGroup>
+    GeodesicSegmentTpl<LieGroup>::GeodesicSegmentTpl (const DevicePtr_t& robot,
+        ConfigurationIn_t q0, ConfigurationIn_t q1)
+      : robot_ (robot), q0_ (), q1_ (), v_ (robot->numberDof ())
+    {
+      reset (q0, q1);
+    }
+
+    template <typename LieGroup>
+    void GeodesicSegmentTpl<LieGroup>::reset (ConfigurationIn_t q0,
+        ConfigurationIn_t q1)
+    {
+      assert (q0.size () == robot_->configSize ());
+      assert (q1.size () == robot_->configSize ());
+      q0_ = q0;
+      q1_ = q1;
+      difference<LieGroup> (robot_, q1, q0, v_);
+    }
+
+    template <typename LieGroup>
+    void GeodesicSegmentTpl<LieGroup>::evaluate (const value_type& u,
+        ConfigurationOut_t result) const
+    {
+      vector_t velocity (robot_->numberDof ());
+      evaluate (u, result, velocity);
+    }
+
+    template <typename LieGroup>
+    void GeodesicSegmentTpl<LieGroup>::evaluate (const value_type& u,
+        ConfigurationOut_t result, vectorOut_t velocity) const
+    {
+      assert (velocity.size () == robot_->numberDof ());
+      if (u == 0) {
+        result = q0_;
+        return;
+      }
+      if (u == 1) {
+        result = q1_;
+        return;
+      }
+      velocity.noalias () = u * v_;
+      integrate<false, LieGroup> (robot_, q0_, velocity, result);
+    }
+
+    template <typename LieGroup>
+    void GeodesicSegmentTpl<LieGroup>::evaluate (vectorIn_t us,
+        matrixOut_t result) const
+    {
+      assert (result.rows () == robot_->configSize ());
+      assert (result.cols () == us.size ());
+      vector_t velocity (robot_->numberDof ());
+      for (size_type i = 0; i < us.size (); ++i)
+        evaluate (us [i], result.col (i), velocity);
+    }
+
+    template class GeodesicSegmentTpl<LieGroupTpl>;
+    template class GeodesicSegmentTpl<DefaultLieGroupMap>;
+  } // namespace pinocchio
+} // namespace hpp
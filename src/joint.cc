@@ -542,7 +542,7 @@ namespace hpp {
     {
       ConfigSpaceVisitor v;
       boost::apply_visitor (v, const_cast <JointModel&> (jointModel ()));
-      return LiegroupSpace::create (v.result ());
+      return LiegroupSpace::canonical (LiegroupSpace::create (v.result ()));
     }
 
     const JointModel& Joint::jointModel() const
@@ -0,0 +1,325 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_SRC_LIEGROUP_BATCH_HH
+# define HPP_PINOCCHIO_SRC_LIEGROUP_BATCH_HH
+
+# include <cmath>
+# include <algorithm>
+
+# include <hpp/pinocchio/liegroup-space.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    namespace liegroupType {
+      /// Kernels on runs of \f$SO(3)\f$ and \f$SE(3)\f$
+      ///
+      /// Elements are processed by packets of PacketSize. The coordinates of
+      /// a packet are loaded in structure of arrays layout, one fixed size
+      /// array per coordinate, so that the arithmetic is vectorized by Eigen
+      /// with the instruction set the library is compiled for.
+      ///
+      /// Quaternions are stored as (x, y, z, w) and tangent vectors of
+      /// \f$SE(3)\f$ as (linear, angular), as in pinocchio.
+      namespace batch {
+        enum { PacketSize = 8 };
+        typedef Eigen::Array <value_type, PacketSize, 1> Packet_t;
+
+        /// Minimal number of elements in a run to use the batch kernels
+        enum { MinRunSize = 4 };
+
+        /// Strided access to a run of elements
+        struct Layout {
+          /// Index of the first element of the run
+          size_type start;
+          /// Size of an element
+          size_type stride;
+        };
+
+        /// Load a coordinate of elements [e, e+n) in a packet
+        /// \param offset index of the coordinate in the element,
+        /// \param padding value of the lanes from n to PacketSize.
+        inline void load (vectorIn_t x, const Layout& l, const size_type& e,
+                          const size_type& n, const size_type& offset,
+                          const value_type& padding, Packet_t& p)
+        {
+          const size_type start (l.start + e * l.stride + offset);
+          for (size_type k = 0; k < n; ++k) p [k] = x [start + k * l.stride];
+          for (size_type k = n; k < PacketSize; ++k) p [k] = padding;
+        }
+
+        /// Store the n first lanes of a packet
+        inline void store (const Packet_t& p, const Layout& l,
+                           const size_type& e, const size_type& n,
+                           const size_type& offset, vectorOut_t x)
+        {
+          const size_type start (l.start + e * l.stride + offset);
+          for (size_type k = 0; k < n; ++k) x [start + k * l.stride] = p [k];
+        }
+
+        /// Vector of packets
+        struct Vec3 {
+          Packet_t x, y, z;
+        };
+        /// Quaternion of packets
+        struct Quat {
+          Packet_t x, y, z, w;
+        };
+
+        inline void loadVec3 (vectorIn_t x, const Layout& l,
+                              const size_type& e, const size_type& n,
+                              const size_type& offset, Vec3& v)
+        {
+          load (x, l, e, n, offset    , 0, v.x);
+          load (x, l, e, n, offset + 1, 0, v.y);
+          load (x, l, e, n, offset + 2, 0, v.z);
+        }
+
+        inline void storeVec3 (const Vec3& v, const Layout& l,
+                               const size_type& e, const size_type& n,
+                               const size_type& offset, vectorOut_t x)
+        {
+          store (v.x, l, e, n, offset    , x);
+          store (v.y, l, e, n, offset + 1, x);
+          store (v.z, l, e, n, offset + 2, x);
+        }
+
+        inline void loadQuat (vectorIn_t x, const Layout& l,
+                              const size_type& e, const size_type& n,
+                              const size_type& offset, Quat& q)
+        {
+          load (x, l, e, n, offset    , 0, q.x);
+          load (x, l, e, n, offset + 1, 0, q.y);
+          load (x, l, e, n, offset + 2, 0, q.z);
+          load (x, l, e, n, offset + 3, 1, q.w);
+        }
+
+        inline void storeQuat (const Quat& q, const Layout& l,
+                               const size_type& e, const size_type& n,
+                               const size_type& offset, vectorOut_t x)
+        {
+          store (q.x, l, e, n, offset    , x);
+          store (q.y, l, e, n, offset + 1, x);
+          store (q.z, l, e, n, offset + 2, x);
+          store (q.w, l, e, n, offset + 3, x);
+        }
+
+        /// r = a x b
+        inline void cross (const Vec3& a, const Vec3& b, Vec3& r)
+        {
+          r.x = a.y * b.z - a.z * b.y;
+          r.y = a.z * b.x - a.x * b.z;
+          r.z = a.x * b.y - a.y * b.x;
+        }
+
+        /// r = a * b
+        inline void multiply (const Quat& a, const Quat& b, Quat& r)
+        {
+          r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+          r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+          r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+          r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+        }
+
+        /// r = conj(a) * b
+        inline void conjMultiply (const Quat& a, const Quat& b, Quat& r)
+        {
+          Quat c; c.x = -a.x; c.y = -a.y; c.z = -a.z; c.w = a.w;
+          multiply (c, b, r);
+        }
+
+        /// Rotate v by unit quaternion q, or by its inverse
+        inline void rotate (const Quat& q, const Vec3& v, Vec3& r,
+                            bool inverse = false)
+        {
+          // r = v + 2 w (u x v) + 2 u x (u x v), u = (x, y, z)
+          Vec3 u; u.x = q.x; u.y = q.y; u.z = q.z;
+          if (inverse) { u.x = -u.x; u.y = -u.y; u.z = -u.z; }
+          Vec3 uv, uuv;
+          cross (u, v, uv);
+          cross (u, uv, uuv);
+          r.x = v.x + 2 * (q.w * uv.x + uuv.x);
+          r.y = v.y + 2 * (q.w * uv.y + uuv.y);
+          r.z = v.z + 2 * (q.w * uv.z + uuv.z);
+        }
+
+        inline void normalize (Quat& q)
+        {
+          const Packet_t inv ((q.x.square () + q.y.square () + q.z.square ()
+                               + q.w.square ()).sqrt ().inverse ());
+          q.x *= inv; q.y *= inv; q.z *= inv; q.w *= inv;
+        }
+
+        /// Exponential of angular velocities, as unit quaternions
+        /// \retval theta2 the squared norm of w
+        inline void exp3 (const Vec3& w, Quat& q, Packet_t& theta2,
+                          Packet_t& theta)
+        {
+          theta2 = w.x.square () + w.y.square () + w.z.square ();
+          theta = theta2.sqrt ();
+          const Packet_t half (value_type (.5) * theta);
+          // sin (theta/2) / theta, with its Taylor expansion near 0.
+          const Packet_t s ((theta2 < 1e-8).select
+                            (value_type (.5) - theta2 / 48,
+                             half.sin () / theta));
+          q.x = s * w.x; q.y = s * w.y; q.z = s * w.z;
+          q.w = half.cos ();
+        }
+
+        /// Log of unit quaternions, as angular velocities
+        /// \param q quaternions, with non negative real part,
+        /// \retval theta the angle of the rotations.
+        inline void log3 (const Quat& q, Vec3& w, Packet_t& theta)
+        {
+          const Packet_t n ((q.x.square () + q.y.square () + q.z.square ())
+                            .sqrt ());
+          for (int k = 0; k < PacketSize; ++k)
+            theta [k] = 2 * std::atan2 (n [k], q.w [k]);
+          // theta / n, with its Taylor expansion near 0.
+          const Packet_t s ((n < 1e-8).select (2 * q.w.inverse (), theta / n));
+          w.x = s * q.x; w.y = s * q.y; w.z = s * q.z;
+        }
+
+        /// Make the real part of quaternions non negative
+        inline void positive (Quat& q)
+        {
+          const Packet_t sign ((q.w < 0).select (Packet_t::Constant (-1),
+                                                 Packet_t::Constant (1)));
+          q.x *= sign; q.y *= sign; q.z *= sign; q.w *= sign;
+        }
+
+        /// Compute \f$ q \leftarrow q \oplus v \f$ on a run of \f$SO(3)\f$
+        inline void integrateSO3 (const LiegroupSpace::Operation& op,
+                                  vectorOut_t q, vectorIn_t v)
+        {
+          const Layout lq = { op.iq, 4 }, lv = { op.iv, 3 };
+          const size_type nb (op.nv / 3);
+          Quat a, dq, r; Vec3 w; Packet_t theta2, theta;
+          for (size_type e = 0; e < nb; e += PacketSize) {
+            const size_type n (std::min <size_type> (PacketSize, nb - e));
+            loadQuat (q, lq, e, n, 0, a);
+            loadVec3 (v, lv, e, n, 0, w);
+            exp3 (w, dq, theta2, theta);
+            multiply (a, dq, r);
+            normalize (r);
+            storeQuat (r, lq, e, n, 0, q);
+          }
+        }
+
+        /// Compute \f$ d = q_1 \ominus q_0 \f$ on a run of \f$SO(3)\f$
+        inline void differenceSO3 (const LiegroupSpace::Operation& op,
+                                   vectorIn_t q0, vectorIn_t q1,
+                                   vectorOut_t d)
+        {
+          const Layout lq = { op.iq, 4 }, lv = { op.iv, 3 };
+          const size_type nb (op.nv / 3);
+          Quat a0, a1, r; Vec3 w; Packet_t theta;
+          for (size_type e = 0; e < nb; e += PacketSize) {
+            const size_type n (std::min <size_type> (PacketSize, nb - e));
+            loadQuat (q0, lq, e, n, 0, a0);
+            loadQuat (q1, lq, e, n, 0, a1);
+            conjMultiply (a0, a1, r);
+            positive (r);
+            log3 (r, w, theta);
+            storeVec3 (w, lv, e, n, 0, d);
+          }
+        }
+
+        /// Compute \f$ q \leftarrow q \oplus v \f$ on a run of \f$SE(3)\f$
+        inline void integrateSE3 (const LiegroupSpace::Operation& op,
+                                  vectorOut_t q, vectorIn_t v)
+        {
+          const Layout lq = { op.iq, 7 }, lv = { op.iv, 6 };
+          const size_type nb (op.nv / 6);
+          Quat a, dq, r; Vec3 p, u, w, wu, wwu, t, Rt;
+          Packet_t theta2, theta;
+          for (size_type e = 0; e < nb; e += PacketSize) {
+            const size_type n (std::min <size_type> (PacketSize, nb - e));
+            loadVec3 (q, lq, e, n, 0, p);
+            loadQuat (q, lq, e, n, 3, a);
+            loadVec3 (v, lv, e, n, 0, u);
+            loadVec3 (v, lv, e, n, 3, w);
+            exp3 (w, dq, theta2, theta);
+
+            // t = V(w) u, V = I + A [w]x + B [w]x^2
+            const Packet_t A ((theta2 < 1e-4).select
+                              (value_type (.5) - theta2 / 24,
+                               (1 - theta.cos ()) / theta2));
+            const Packet_t B ((theta2 < 1e-4).select
+                              (value_type (1) / 6 - theta2 / 120,
+                               (theta - theta.sin ()) / (theta2 * theta)));
+            cross (w, u, wu);
+            cross (w, wu, wwu);
+            t.x = u.x + A * wu.x + B * wwu.x;
+            t.y = u.y + A * wu.y + B * wwu.y;
+            t.z = u.z + A * wu.z + B * wwu.z;
+
+            rotate (a, t, Rt);
+            p.x += Rt.x; p.y += Rt.y; p.z += Rt.z;
+            multiply (a, dq, r);
+            normalize (r);
+            storeVec3 (p, lq, e, n, 0, q);
+            storeQuat (r, lq, e, n, 3, q);
+          }
+        }
+
+        /// Compute \f$ d = q_1 \ominus q_0 \f$ on a run of \f$SE(3)\f$
+        inline void differenceSE3 (const LiegroupSpace::Operation& op,
+                                   vectorIn_t q0, vectorIn_t q1,
+                                   vectorOut_t d)
+        {
+          const Layout lq = { op.iq, 7 }, lv = { op.iv, 6 };
+          const size_type nb (op.nv / 6);
+          Quat a0, a1, r; Vec3 p0, p1, dp, t, w, wt, wwt;
+          Packet_t theta;
+          for (size_type e = 0; e < nb; e += PacketSize) {
+            const size_type n (std::min <size_type> (PacketSize, nb - e));
+            loadVec3 (q0, lq, e, n, 0, p0);
+            loadQuat (q0, lq, e, n, 3, a0);
+            loadVec3 (q1, lq, e, n, 0, p1);
+            loadQuat (q1, lq, e, n, 3, a1);
+
+            // Rotation of M0^{-1} M1
+            conjMultiply (a0, a1, r);
+            positive (r);
+            log3 (r, w, theta);
+
+            // Translation of M0^{-1} M1
+            dp.x = p1.x - p0.x; dp.y = p1.y - p0.y; dp.z = p1.z - p0.z;
+            rotate (a0, dp, t, true);
+
+            // u = V(w)^{-1} t, V^{-1} = I - 1/2 [w]x + C [w]x^2
+            const Packet_t theta2 (theta.square ());
+            const Packet_t C ((theta2 < 1e-4).select
+                              (value_type (1) / 12 + theta2 / 720,
+                               (1 - theta * theta.sin ()
+                                / (2 * (1 - theta.cos ()))) / theta2));
+            cross (w, t, wt);
+            cross (w, wt, wwt);
+            t.x = t.x - value_type (.5) * wt.x + C * wwt.x;
+            t.y = t.y - value_type (.5) * wt.y + C * wwt.y;
+            t.z = t.z - value_type (.5) * wt.z + C * wwt.z;
+
+            storeVec3 (t, lv, e, n, 0, d);
+            storeVec3 (w, lv, e, n, 3, d);
+          }
+        }
+      } // namespace batch
+    } // namespace liegroupType
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_SRC_LIEGROUP_BATCH_HH
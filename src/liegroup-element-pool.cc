@@ -0,0 +1,115 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/liegroup-element-pool.hh>
+
+#include <algorithm>
+
+#include "../src/liegroup-operations.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    void integrate (LiegroupConstElementView e, vectorIn_t v,
+                    LiegroupElementView result)
+    {
+      assert (e.space () == result.space () || *e.space () == *result.space ());
+      assert (v.size () == e.space ()->nv ());
+      LiegroupElementView::Map_t q (result.vector ());
+      if (result.data () != e.data ()) q = e.vector ();
+      liegroupType::integrate (e.space ()->operations (), q, v);
+    }
+
+    void difference (LiegroupConstElementView e1, LiegroupConstElementView e2,
+                     vectorOut_t result)
+    {
+      assert (e1.space ()->nq () == e2.space ()->nq ());
+      assert (result.size () == e1.space ()->nv ());
+      liegroupType::difference (e1.space ()->operations (), e2.vector (),
+                                e1.vector (), result);
+    }
+
+    LiegroupElementPool::LiegroupElementPool (const LiegroupSpacePtr_t& space,
+                                              const size_type& capacity)
+      : space_ (space), data_ (space->nq (), capacity), size_ (0)
+    {
+    }
+
+    void LiegroupElementPool::reserve (const size_type& n)
+    {
+      if (n > data_.cols ()) data_.conservativeResize (Eigen::NoChange, n);
+    }
+
+    void LiegroupElementPool::resize (const size_type& n)
+    {
+      reserve (n);
+      if (n > size_)
+        data_.middleCols (size_, n - size_)
+          = space_->neutral ().vector ().replicate (1, n - size_);
+      size_ = n;
+    }
+
+    size_type LiegroupElementPool::push_back (vectorIn_t q)
+    {
+      assert (q.size () == space_->nq ());
+      if (size_ == data_.cols ())
+        reserve (std::max <size_type> (2 * size_, 16));
+      data_.col (size_) = q;
+      return size_++;
+    }
+
+    void LiegroupElementPool::integrate (matrixIn_t velocities)
+    {
+      assert (velocities.rows () == space_->nv ());
+      assert (velocities.cols () == size_);
+      const LiegroupSpace::Operations_t& ops (space_->operations ());
+      for (size_type i = 0; i < size_; ++i)
+        liegroupType::integrate (ops, data_.col (i), velocities.col (i));
+    }
+
+    void LiegroupElementPool::difference (vectorIn_t q,
+                                          matrixOut_t result) const
+    {
+      assert (q.size () == space_->nq ());
+      assert (result.rows () == space_->nv ());
+      assert (result.cols () == size_);
+      const LiegroupSpace::Operations_t& ops (space_->operations ());
+      for (size_type i = 0; i < size_; ++i)
+        liegroupType::difference (ops, q, data_.col (i), result.col (i));
+    }
+
+    void LiegroupElementPool::difference (const LiegroupElementPool& other,
+                                          matrixOut_t result) const
+    {
+      assert (*other.space_ == *space_);
+      assert (other.size_ == size_);
+      assert (result.rows () == space_->nv ());
+      assert (result.cols () == size_);
+      const LiegroupSpace::Operations_t& ops (space_->operations ());
+      for (size_type i = 0; i < size_; ++i)
+        liegroupType::difference (ops, other.data_.col (i), data_.col (i),
+                                  result.col (i));
+    }
+
+    void LiegroupElementPool::log (matrixOut_t result) const
+    {
+      assert (result.rows () == space_->nv ());
+      assert (result.cols () == size_);
+      const LiegroupSpace::Operations_t& ops (space_->operations ());
+      for (size_type i = 0; i < size_; ++i)
+        liegroupType::log (ops, data_.col (i), result.col (i));
+    }
+  } // namespace pinocchio
+} // namespace hpp
@@ -15,44 +15,40 @@
 // hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
 
 #include <hpp/pinocchio/liegroup-element.hh>
-#include "../src/size-visitor.hh"
-#include "../src/addition-visitor.hh"
-#include "../src/substraction-visitor.hh"
-#include "../src/log-visitor.hh"
+#include "../src/liegroup-operations.hh"
 
 namespace hpp {
   namespace pinocchio {
-    typedef std::vector <LiegroupType> LiegroupTypes;
-
     template <typename vector_type>
     LiegroupNonconstElementBase<vector_type>& LiegroupNonconstElementBase<vector_type>::operator+= (vectorIn_t v)
     {
       assert (this->space_->nv () == v.size ());
-      typedef std::vector <LiegroupType> LiegroupTypes;
-      size_type iq = 0, iv = 0;
-      for (LiegroupTypes::const_iterator it = this->space_->liegroupTypes ().begin ();
-           it != this->space_->liegroupTypes ().end (); ++it) {
-        liegroupType::SizeVisitor dv;
-        boost::apply_visitor (dv, *it);
-
-        liegroupType::AdditionVisitor av (this->value_.segment (iq, dv.nq),
-                                          v.segment (iv, dv.nv));
-        boost::apply_visitor (av, *it);
-        // result.value_.segment (iq, dv.nq) = av.result;
-        iq += dv.nq;
-        iv += dv.nv;
-      }
+      liegroupType::integrate (this->space_->operations (), this->value_, v);
       return *this;
     }
 
     template LiegroupNonconstElementBase<vector_t   >& LiegroupNonconstElementBase<vector_t   >::operator+= (vectorIn_t);
     template LiegroupNonconstElementBase<vectorOut_t>& LiegroupNonconstElementBase<vectorOut_t>::operator+= (vectorIn_t);
 
+    template <typename vector_type>
+    void integrate (const LiegroupElementBase<vector_type>& e, vectorIn_t v,
+                    LiegroupElementRef result)
+    {
+      assert (e.space ()->nv () == v.size ());
+      assert (*e.space () == *result.space ());
+      result.vector () = e.vector ();
+      liegroupType::integrate (e.space ()->operations (), result.vector (), v);
+    }
+
+    template void integrate (const LiegroupElementBase<vector_t   >& e, vectorIn_t v, LiegroupElementRef result);
+    template void integrate (const LiegroupElementBase<vectorIn_t >& e, vectorIn_t v, LiegroupElementRef result);
+    template void integrate (const LiegroupElementBase<vectorOut_t>& e, vectorIn_t v, LiegroupElementRef result);
+
     template <typename vector_type>
     LiegroupElement operator+ (const LiegroupElementBase<vector_type>& e, vectorIn_t v)
     {
-      LiegroupElement result (e);
-      result += v;
+      LiegroupElement result (e.space ());
+      integrate (e, v, LiegroupElementRef (result.vector (), result.space ()));
       return result;
     }
 
@@ -61,32 +57,31 @@ namespace hpp {
     template LiegroupElement operator+ (const LiegroupElementBase<vectorOut_t>& e, vectorIn_t v);
 
     template <typename vector_type1, typename vector_type2>
-    vector_t operator- (const LiegroupElementBase<vector_type1>& e1, const LiegroupElementBase<vector_type2>& e2)
+    void difference (const LiegroupElementBase<vector_type1>& e1,
+                     const LiegroupElementBase<vector_type2>& e2,
+                     vectorOut_t result)
     {
       assert (e1.space ()->nq () == e2.space ()->nq ());
-      typedef std::vector <LiegroupType> LiegroupTypes;
-      vector_t result (e1.space ()->nv ());
-      size_type iq = 0, iv = 0;
-
-      LiegroupTypes::const_iterator it1 =
-        e1.space ()->liegroupTypes ().begin ();
-      LiegroupTypes::const_iterator it2 =
-        e2.space ()->liegroupTypes ().begin ();
+      assert (result.size () == e1.space ()->nv ());
+      liegroupType::difference (e1.space ()->operations (), e2.vector (),
+                                e1.vector (), result);
+    }
 
-      while ((it1 != e1.space ()->liegroupTypes ().end ()) &&
-             (it2 != e2.space ()->liegroupTypes ().end ())) {
-        liegroupType::SizeVisitor dv;
-        boost::apply_visitor (dv, *it1);
+    template void difference (const LiegroupElementBase<vector_t   >& e1, const LiegroupElementBase<vector_t   >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vector_t   >& e1, const LiegroupElementBase<vectorIn_t >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vector_t   >& e1, const LiegroupElementBase<vectorOut_t>& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorIn_t >& e1, const LiegroupElementBase<vector_t   >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorIn_t >& e1, const LiegroupElementBase<vectorIn_t >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorIn_t >& e1, const LiegroupElementBase<vectorOut_t>& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorOut_t>& e1, const LiegroupElementBase<vector_t   >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorOut_t>& e1, const LiegroupElementBase<vectorIn_t >& e2, vectorOut_t result);
+    template void difference (const LiegroupElementBase<vectorOut_t>& e1, const LiegroupElementBase<vectorOut_t>& e2, vectorOut_t result);
 
-        liegroupType::SubstractionVisitor sv (e1.vector().segment (iq, dv.nq),
-                                              e2.vector().segment (iq, dv.nq),
-                                              e1.space ()->nv ());
-        boost::apply_visitor (sv, *it1);
-        result.segment (iv, dv.nv) = sv.result;
-        iq += dv.nq;
-        iv += dv.nv;
-        ++it1; ++it2;
-      }
+    template <typename vector_type1, typename vector_type2>
+    vector_t operator- (const LiegroupElementBase<vector_type1>& e1, const LiegroupElementBase<vector_type2>& e2)
+    {
+      vector_t result (e1.space ()->nv ());
+      difference (e1, e2, result);
       return result;
     }
 
@@ -100,21 +95,22 @@ namespace hpp {
     template vector_t operator- (const LiegroupElementBase<vectorOut_t>& e1, const LiegroupElementBase<vectorIn_t >& e2);
     template vector_t operator- (const LiegroupElementBase<vectorOut_t>& e1, const LiegroupElementBase<vectorOut_t>& e2);
 
+    template <typename vector_type>
+    void log (const LiegroupElementBase<vector_type>& lge, vectorOut_t result)
+    {
+      assert (result.size () == lge.space ()->nv ());
+      liegroupType::log (lge.space ()->operations (), lge.vector (), result);
+    }
+
+    template void log (const LiegroupElementBase<vector_t   >& lge, vectorOut_t result);
+    template void log (const LiegroupElementBase<vectorIn_t >& lge, vectorOut_t result);
+    template void log (const LiegroupElementBase<vectorOut_t>& lge, vectorOut_t result);
+
     template <typename vector_type>
     vector_t log (const LiegroupElementBase<vector_type>& lge)
     {
-      using liegroupType::LogVisitor;
       vector_t res (lge.space ()->nv ());
-      size_type iq = 0, iv = 0;
-      for (LiegroupTypes::const_iterator it =
-           lge.space ()->liegroupTypes ().begin ();
-           it != lge.space ()->liegroupTypes ().end (); ++it) {
-        liegroupType::SizeVisitor sizeVisitor;
-        boost::apply_visitor (sizeVisitor, *it);
-        LogVisitor logVisitor (lge.vector ().segment (iq, sizeVisitor.nq),
-                               res.segment (iv, sizeVisitor.nv));
-        boost::apply_visitor (logVisitor, *it);
-      }
+      log (lge, res);
       return res;
     }
 
@@ -0,0 +1,429 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_SRC_LIEGROUP_OPERATIONS_HH
+# define HPP_PINOCCHIO_SRC_LIEGROUP_OPERATIONS_HH
+
+# include <Eigen/Geometry>
+
+# include <hpp/pinocchio/liegroup-space.hh>
+# include <hpp/pinocchio/block-diagonal-matrix.hh>
+
+# include "../src/liegroup-batch.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    namespace liegroupType {
+      typedef LiegroupSpace::Operation Operation;
+      typedef LiegroupSpace::Operations_t Operations_t;
+      typedef Eigen::Quaternion <value_type> quaternion_t;
+
+      /// Visitor that appends the operations of a LiegroupType to a plan
+      struct OperationsVisitor : public boost::static_visitor <>
+      {
+        OperationsVisitor (Operations_t& ops) : ops_ (ops), iq_ (0), iv_ (0)
+        {}
+
+        void push (Operation::Kind_t kind, const size_type& nq,
+                   const size_type& nv)
+        {
+          if (!ops_.empty () && ops_.back ().kind == kind) {
+            ops_.back ().nq += nq;
+            ops_.back ().nv += nv;
+          } else {
+            Operation op;
+            op.kind = kind; op.iq = iq_; op.iv = iv_; op.nq = nq; op.nv = nv;
+            ops_.push_back (op);
+          }
+          iq_ += nq;
+          iv_ += nv;
+        }
+
+        template <int N, bool rot>
+        void operator () (const liegroup::VectorSpaceOperation<N, rot>& lg)
+        {
+          if (lg.nq () > 0) push (Operation::VECTOR_SPACE, lg.nq (), lg.nv ());
+        }
+
+        void operator () (const liegroup::SpecialOrthogonalOperation<2>&)
+        {
+          push (Operation::SO2, 2, 1);
+        }
+
+        void operator () (const liegroup::SpecialOrthogonalOperation<3>&)
+        {
+          push (Operation::SO3, 4, 3);
+        }
+
+        template <typename LgT1, typename LgT2>
+        void operator () (const liegroup::CartesianProductOperation<LgT1, LgT2>&)
+        {
+          (*this) (LgT1 ());
+          (*this) (LgT2 ());
+        }
+
+        void operator () (const se3::SpecialEuclideanOperation<2>&)
+        {
+          push (Operation::SE2, 4, 3);
+        }
+
+        void operator () (const se3::SpecialEuclideanOperation<3>&)
+        {
+          push (Operation::SE3, 7, 6);
+        }
+
+        Operations_t& ops_;
+        size_type iq_, iv_;
+      }; // struct OperationsVisitor
+
+      /// \name Kernels applied to a run of identical elementary Lie groups
+      /// \{
+
+      template <typename LgT>
+      inline void integrateRun (const Operation& op, vectorOut_t q,
+                                vectorIn_t v)
+      {
+        LgT lg;
+        for (size_type iq = op.iq, iv = op.iv; iq < op.iq + op.nq;
+             iq += LgT::NQ, iv += LgT::NV)
+          lg.integrate_impl (q.segment<LgT::NQ> (iq),
+                             v.segment<LgT::NV> (iv),
+                             q.segment<LgT::NQ> (iq));
+      }
+
+      template <typename LgT>
+      inline void differenceRun (const Operation& op, vectorIn_t q0,
+                                 vectorIn_t q1, vectorOut_t d)
+      {
+        LgT lg;
+        for (size_type iq = op.iq, iv = op.iv; iq < op.iq + op.nq;
+             iq += LgT::NQ, iv += LgT::NV)
+          lg.difference_impl (q0.segment<LgT::NQ> (iq),
+                              q1.segment<LgT::NQ> (iq),
+                              d.segment<LgT::NV> (iv));
+      }
+
+      template <typename LgT>
+      inline void logRun (const Operation& op, vectorIn_t q, vectorOut_t res)
+      {
+        LgT lg;
+        const typename LgT::ConfigVector_t neutral (lg.neutral ());
+        for (size_type iq = op.iq, iv = op.iv; iq < op.iq + op.nq;
+             iq += LgT::NQ, iv += LgT::NV)
+          lg.difference_impl (neutral, q.segment<LgT::NQ> (iq),
+                              res.segment<LgT::NV> (iv));
+      }
+
+      template <typename LgT>
+      inline void JintegrateRun (const Operation& op, vectorIn_t v,
+                                 matrixOut_t J)
+      {
+        LgT lg;
+        typename LgT::JacobianMatrix_t Jint;
+        for (size_type iv = op.iv; iv < op.iv + op.nv; iv += LgT::NV) {
+          lg.Jintegrate (v.segment<LgT::NV> (iv), Jint);
+          BlockDiagonalMatrix::applyDenseOnTheLeft (Jint, iv, J);
+        }
+      }
+
+      template <typename LgT>
+      inline void JintegrateRun (const Operation& op, vectorIn_t v,
+                                 BlockDiagonalMatrix& J)
+      {
+        LgT lg;
+        typename LgT::JacobianMatrix_t Jint;
+        for (size_type iv = op.iv; iv < op.iv + op.nv; iv += LgT::NV) {
+          lg.Jintegrate (v.segment<LgT::NV> (iv), Jint);
+          J.pushDense (Jint);
+        }
+      }
+
+      template <typename LgT, bool ApplyOnTheLeft>
+      inline void JdifferenceRun (const Operation& op, vectorIn_t q0,
+                                  vectorIn_t q1, matrixOut_t J0,
+                                  matrixOut_t J1)
+      {
+        LgT lg;
+        typename LgT::JacobianMatrix_t J0int, J1int;
+        for (size_type iq = op.iq, iv = op.iv; iq < op.iq + op.nq;
+             iq += LgT::NQ, iv += LgT::NV) {
+          lg.Jdifference (q0.segment<LgT::NQ> (iq), q1.segment<LgT::NQ> (iq),
+                          J0int, J1int);
+          if (J0.size() > 0) {
+            if (ApplyOnTheLeft)
+              BlockDiagonalMatrix::applyDenseOnTheLeft  (J0int, iv, J0);
+            else
+              BlockDiagonalMatrix::applyDenseOnTheRight (J0int, iv, J0);
+          }
+          if (J1.size() > 0) {
+            if (ApplyOnTheLeft)
+              BlockDiagonalMatrix::applyDenseOnTheLeft  (J1int, iv, J1);
+            else
+              BlockDiagonalMatrix::applyDenseOnTheRight (J1int, iv, J1);
+          }
+        }
+      }
+
+      template <typename LgT>
+      inline void JdifferenceRun (const Operation& op, vectorIn_t q0,
+                                  vectorIn_t q1, BlockDiagonalMatrix& J0,
+                                  BlockDiagonalMatrix& J1)
+      {
+        LgT lg;
+        typename LgT::JacobianMatrix_t J0int, J1int;
+        for (size_type iq = op.iq, iv = op.iv; iq < op.iq + op.nq;
+             iq += LgT::NQ, iv += LgT::NV) {
+          lg.Jdifference (q0.segment<LgT::NQ> (iq), q1.segment<LgT::NQ> (iq),
+                          J0int, J1int);
+          J0.pushDense (J0int);
+          J1.pushDense (J1int);
+        }
+      }
+      /// \}
+
+      /// \name Operations on a cartesian product of Lie groups
+      /// \{
+
+      /// Compute \f$ q \leftarrow q + v \f$
+      inline void integrate (const Operations_t& ops, vectorOut_t q,
+                             vectorIn_t v)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              q.segment (op.iq, op.nq) += v.segment (op.iv, op.nv);
+              break;
+            case Operation::SO2:
+              integrateRun <liegroup::SpecialOrthogonalOperation<2> > (op, q, v);
+              break;
+            case Operation::SO3:
+              if (op.nv >= 3 * batch::MinRunSize)
+                batch::integrateSO3 (op, q, v);
+              else
+                integrateRun <liegroup::SpecialOrthogonalOperation<3> > (op, q, v);
+              break;
+            case Operation::SE2:
+              integrateRun <se3::SpecialEuclideanOperation<2> > (op, q, v);
+              break;
+            case Operation::SE3:
+              if (op.nv >= 6 * batch::MinRunSize)
+                batch::integrateSE3 (op, q, v);
+              else
+                integrateRun <se3::SpecialEuclideanOperation<3> > (op, q, v);
+              break;
+          }
+        }
+      }
+
+      /// Compute \f$ d = q_1 - q_0 \f$
+      inline void difference (const Operations_t& ops, vectorIn_t q0,
+                              vectorIn_t q1, vectorOut_t d)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              d.segment (op.iv, op.nv) = q1.segment (op.iq, op.nq)
+                - q0.segment (op.iq, op.nq);
+              break;
+            case Operation::SO2:
+              differenceRun <liegroup::SpecialOrthogonalOperation<2> >
+                (op, q0, q1, d);
+              break;
+            case Operation::SO3:
+              if (op.nv >= 3 * batch::MinRunSize)
+                batch::differenceSO3 (op, q0, q1, d);
+              else
+                differenceRun <liegroup::SpecialOrthogonalOperation<3> >
+                  (op, q0, q1, d);
+              break;
+            case Operation::SE2:
+              differenceRun <se3::SpecialEuclideanOperation<2> >
+                (op, q0, q1, d);
+              break;
+            case Operation::SE3:
+              if (op.nv >= 6 * batch::MinRunSize)
+                batch::differenceSE3 (op, q0, q1, d);
+              else
+                differenceRun <se3::SpecialEuclideanOperation<3> >
+                  (op, q0, q1, d);
+              break;
+          }
+        }
+      }
+
+      /// Compute the log of q
+      inline void log (const Operations_t& ops, vectorIn_t q, vectorOut_t res)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              res.segment (op.iv, op.nv) = q.segment (op.iq, op.nq);
+              break;
+            case Operation::SO2:
+              for (size_type k = 0; k < op.nv; ++k)
+                res [op.iv + k] = atan2 (q [op.iq + 2*k + 1], q [op.iq + 2*k]);
+              break;
+            case Operation::SO3:
+              for (size_type k = 0; 3*k < op.nv; ++k) {
+                quaternion_t quat (q.segment<4> (op.iq + 4*k));
+                Eigen::AngleAxis <value_type> u (quat);
+                if (u.angle() > M_PI)
+                  res.segment<3> (op.iv + 3*k) = -(2*M_PI - u.angle()) * u.axis();
+                else
+                  res.segment<3> (op.iv + 3*k) = u.angle() * u.axis();
+              }
+              break;
+            case Operation::SE2:
+              logRun <se3::SpecialEuclideanOperation<2> > (op, q, res);
+              break;
+            case Operation::SE3:
+              logRun <se3::SpecialEuclideanOperation<3> > (op, q, res);
+              break;
+          }
+        }
+      }
+
+      /// Compute the Jacobian of the integration operation
+      /// \sa LiegroupSpace::Jintegrate
+      inline void Jintegrate (const Operations_t& ops, vectorIn_t v,
+                              matrixOut_t J)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              break;
+            case Operation::SO2:
+              JintegrateRun <liegroup::SpecialOrthogonalOperation<2> > (op, v, J);
+              break;
+            case Operation::SO3:
+              JintegrateRun <liegroup::SpecialOrthogonalOperation<3> > (op, v, J);
+              break;
+            case Operation::SE2:
+              JintegrateRun <se3::SpecialEuclideanOperation<2> > (op, v, J);
+              break;
+            case Operation::SE3:
+              JintegrateRun <se3::SpecialEuclideanOperation<3> > (op, v, J);
+              break;
+          }
+        }
+      }
+
+      /// Compute the Jacobian of the difference operation
+      /// \sa LiegroupSpace::Jdifference
+      template <bool ApplyOnTheLeft>
+      inline void Jdifference (const Operations_t& ops, vectorIn_t q0,
+                               vectorIn_t q1, matrixOut_t J0, matrixOut_t J1)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              if (J0.size() > 0) {
+                if (ApplyOnTheLeft) J0.middleRows (op.iv, op.nv) *= -1;
+                else                J0.middleCols (op.iv, op.nv) *= -1;
+              }
+              break;
+            case Operation::SO2:
+              JdifferenceRun <liegroup::SpecialOrthogonalOperation<2>,
+                             ApplyOnTheLeft> (op, q0, q1, J0, J1);
+              break;
+            case Operation::SO3:
+              JdifferenceRun <liegroup::SpecialOrthogonalOperation<3>,
+                             ApplyOnTheLeft> (op, q0, q1, J0, J1);
+              break;
+            case Operation::SE2:
+              JdifferenceRun <se3::SpecialEuclideanOperation<2>,
+                             ApplyOnTheLeft> (op, q0, q1, J0, J1);
+              break;
+            case Operation::SE3:
+              JdifferenceRun <se3::SpecialEuclideanOperation<3>,
+                             ApplyOnTheLeft> (op, q0, q1, J0, J1);
+              break;
+          }
+        }
+      }
+
+      /// Compute the Jacobian of the integration operation as a block
+      /// diagonal matrix
+      /// \sa LiegroupSpace::Jintegrate
+      inline void Jintegrate (const Operations_t& ops, vectorIn_t v,
+                              BlockDiagonalMatrix& J)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              J.pushIdentity (op.nv);
+              break;
+            case Operation::SO2:
+              JintegrateRun <liegroup::SpecialOrthogonalOperation<2> > (op, v, J);
+              break;
+            case Operation::SO3:
+              JintegrateRun <liegroup::SpecialOrthogonalOperation<3> > (op, v, J);
+              break;
+            case Operation::SE2:
+              JintegrateRun <se3::SpecialEuclideanOperation<2> > (op, v, J);
+              break;
+            case Operation::SE3:
+              JintegrateRun <se3::SpecialEuclideanOperation<3> > (op, v, J);
+              break;
+          }
+        }
+      }
+
+      /// Compute the Jacobians of the difference operation as block
+      /// diagonal matrices
+      /// \sa LiegroupSpace::Jdifference
+      inline void Jdifference (const Operations_t& ops, vectorIn_t q0,
+                               vectorIn_t q1, BlockDiagonalMatrix& J0,
+                               BlockDiagonalMatrix& J1)
+      {
+        for (std::size_t i = 0; i < ops.size (); ++i) {
+          const Operation& op (ops [i]);
+          switch (op.kind) {
+            case Operation::VECTOR_SPACE:
+              J0.pushIdentity (op.nv, true);
+              J1.pushIdentity (op.nv);
+              break;
+            case Operation::SO2:
+              JdifferenceRun <liegroup::SpecialOrthogonalOperation<2> >
+                (op, q0, q1, J0, J1);
+              break;
+            case Operation::SO3:
+              JdifferenceRun <liegroup::SpecialOrthogonalOperation<3> >
+                (op, q0, q1, J0, J1);
+              break;
+            case Operation::SE2:
+              JdifferenceRun <se3::SpecialEuclideanOperation<2> >
+                (op, q0, q1, J0, J1);
+              break;
+            case Operation::SE3:
+              JdifferenceRun <se3::SpecialEuclideanOperation<3> >
+                (op, q0, q1, J0, J1);
+              break;
+          }
+        }
+      }
+      /// \}
+    } // namespace liegroupType
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_SRC_LIEGROUP_OPERATIONS_HH
@@ -14,15 +14,77 @@
 // received a copy of the GNU Lesser General Public License along with
 // hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
 
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <hpp/util/exception-factory.hh>
 #include <hpp/pinocchio/liegroup-element.hh>
 #include <hpp/pinocchio/liegroup-space.hh>
 #include "../src/comparison.hh"
 #include "../src/size-visitor.hh"
-#include "../src/jintegrate-visitor.hh"
-#include "../src/jdifference-visitor.hh"
+#include "../src/liegroup-operations.hh"
 
 namespace hpp {
   namespace pinocchio {
+    namespace {
+      /// Registry of canonical instances, sorted by hash
+      struct Registry
+      {
+        typedef std::multimap <std::size_t, LiegroupSpaceWkPtr_t> Spaces_t;
+        boost::mutex mutex;
+        Spaces_t spaces;
+      }; // struct Registry
+
+      Registry& registry ()
+      {
+        // Never destroyed so that canonical instances held by static
+        // variables can unregister themselves at exit.
+        static Registry* r (new Registry);
+        return *r;
+      }
+    } // namespace
+
+    LiegroupSpacePtr_t LiegroupSpace::canonical
+    (const LiegroupSpacePtr_t& space)
+    {
+      // canonical_ is only set on the private copies below, before they
+      // are published through the registry.
+      if (space->canonical_) return space;
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      std::pair <Registry::Spaces_t::iterator, Registry::Spaces_t::iterator>
+        range (r.spaces.equal_range (space->hash_));
+      for (Registry::Spaces_t::iterator it = range.first;
+           it != range.second;) {
+        LiegroupSpacePtr_t s (it->second.lock ());
+        if (!s) {
+          // The instance has been deleted.
+          r.spaces.erase (it++);
+          continue;
+        }
+        if (*s == *space) return s;
+        ++it;
+      }
+      LiegroupSpacePtr_t copy (createCopy (space));
+      copy->canonical_ = true;
+      r.spaces.insert (std::make_pair (copy->hash_,
+                                       LiegroupSpaceWkPtr_t (copy)));
+      return copy;
+    }
+
+    LiegroupSpace::~LiegroupSpace ()
+    {
+      if (!canonical_) return;
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      std::pair <Registry::Spaces_t::iterator, Registry::Spaces_t::iterator>
+        range (r.spaces.equal_range (hash_));
+      for (Registry::Spaces_t::iterator it = range.first;
+           it != range.second;) {
+        // The entry of this instance has already expired.
+        if (it->second.expired ()) r.spaces.erase (it++);
+        else ++it;
+      }
+    }
 
     LiegroupSpacePtr_t LiegroupSpace::Rn (const size_type& n)
     {
@@ -129,30 +191,36 @@ namespace hpp {
     {
       assert (v.size() == nv());
       assert (J.rows() == nv());
-      size_type row = 0;
-      liegroupType::JintegrateVisitor jiv (v, J, row);
-      for (std::size_t i = 0; i < liegroupTypes_.size (); ++i) {
-        boost::apply_visitor (jiv, liegroupTypes_ [i]);
-      }
-      assert (row == nv());
+      liegroupType::Jintegrate (operations_, v, J);
     }
 
     template <bool ApplyOnTheLeft>
     void LiegroupSpace::Jdifference (vectorIn_t q0, vectorIn_t q1, matrixOut_t J0, matrixOut_t J1) const
     {
       assert (q0.size() == nq() && q1.size() == nq());
-
-      liegroupType::JdifferenceVisitor<ApplyOnTheLeft> jdv (q0,q1,J0,J1);
-      for (std::size_t i = 0; i < liegroupTypes_.size (); ++i) {
-        boost::apply_visitor (jdv, liegroupTypes_ [i]);
-      }
-      assert (jdv.iq_ == nq());
-      assert (jdv.iv_ == nv());
+      liegroupType::Jdifference<ApplyOnTheLeft> (operations_, q0, q1, J0, J1);
     }
 
     template void LiegroupSpace::Jdifference<true > (vectorIn_t q0, vectorIn_t q1, matrixOut_t J0, matrixOut_t J1) const;
     template void LiegroupSpace::Jdifference<false> (vectorIn_t q0, vectorIn_t q1, matrixOut_t J0, matrixOut_t J1) const;
 
+    void LiegroupSpace::Jintegrate (vectorIn_t v, BlockDiagonalMatrix& J) const
+    {
+      assert (v.size() == nv());
+      J.resize (nv());
+      liegroupType::Jintegrate (operations_, v, J);
+    }
+
+    void LiegroupSpace::Jdifference (vectorIn_t q0, vectorIn_t q1,
+                                     BlockDiagonalMatrix& J0,
+                                     BlockDiagonalMatrix& J1) const
+    {
+      assert (q0.size() == nq() && q1.size() == nq());
+      J0.resize (nv());
+      J1.resize (nv());
+      liegroupType::Jdifference (operations_, q0, q1, J0, J1);
+    }
+
     struct NameVisitor : public boost::static_visitor <>
     {
       template <typename LgT1> void operator () (const LgT1& lg1)
@@ -182,6 +250,11 @@ namespace hpp {
 
     bool LiegroupSpace::operator== (const LiegroupSpace& other) const
     {
+      if (this == &other) return true;
+      if (hash_ != other.hash_ || nq_ != other.nq_ || nv_ != other.nv_)
+        return false;
+      // There is only one canonical instance per Lie group.
+      if (canonical_ && other.canonical_) return false;
       if (liegroupTypes_.size () != other.liegroupTypes ().size ())
         return false;
       LiegroupTypes::const_iterator it1 (liegroupTypes_.begin ());
@@ -203,11 +276,13 @@ namespace hpp {
 
     // Constructors
     LiegroupSpace::LiegroupSpace () :
-      nq_ (0), nv_ (0), nqs_ (), nvs_ (), neutral_ (), weak_ ()
+      nq_ (0), nv_ (0), nqs_ (), nvs_ (), operations_ (), neutral_ (),
+      hash_ (0), canonical_ (false), weak_ ()
     {}
 
     LiegroupSpace::LiegroupSpace (const size_type& size) :
-      nq_ (0), nv_ (0), nqs_ (), nvs_ (), neutral_ (), weak_ ()
+      nq_ (0), nv_ (0), nqs_ (), nvs_ (), operations_ (), neutral_ (),
+      hash_ (0), canonical_ (false), weak_ ()
     {
       liegroupTypes_.push_back
         (liegroup::VectorSpaceOperation <Eigen::Dynamic, false> ((int) size));
@@ -218,12 +293,15 @@ namespace hpp {
 
     LiegroupSpace::LiegroupSpace (const LiegroupSpace& other) :
       liegroupTypes_ (other.liegroupTypes_), nq_ (other.nq_), nv_ (other.nv_),
-      nqs_ (other.nqs_), nvs_ (other.nvs_), neutral_ (other.neutral_), weak_ ()
+      nqs_ (other.nqs_), nvs_ (other.nvs_), operations_ (other.operations_),
+      neutral_ (other.neutral_), hash_ (other.hash_), canonical_ (false),
+      weak_ ()
     {
     }
 
     LiegroupSpace::LiegroupSpace (const LiegroupType& type) :
-      liegroupTypes_ (), nqs_ (), nvs_ (), neutral_ (), weak_ ()
+      liegroupTypes_ (), nqs_ (), nvs_ (), operations_ (), neutral_ (),
+      hash_ (0), canonical_ (false), weak_ ()
     {
       liegroupTypes_.push_back (type);
       computeSize ();
@@ -244,6 +322,29 @@ namespace hpp {
         nqs_.push_back (v.nq);
         nvs_.push_back (v.nv);
       }
+      computeOperations ();
+      computeHash ();
+    }
+
+    void LiegroupSpace::computeOperations ()
+    {
+      operations_.clear ();
+      liegroupType::OperationsVisitor v (operations_);
+      for (LiegroupTypes::const_iterator it = liegroupTypes_.begin ();
+           it != liegroupTypes_.end (); ++it)
+        boost::apply_visitor (v, *it);
+      assert (v.iq_ == nq_);
+      assert (v.iv_ == nv_);
+    }
+
+    void LiegroupSpace::computeHash ()
+    {
+      hash_ = 0;
+      for (LiegroupTypes::const_iterator it = liegroupTypes_.begin ();
+           it != liegroupTypes_.end (); ++it) {
+        liegroupType::HashVisitor v (hash_, it->which ());
+        boost::apply_visitor (v, *it);
+      }
     }
 
     void LiegroupSpace::computeNeutral ()
@@ -267,6 +368,9 @@ namespace hpp {
 
     void LiegroupSpace::mergeVectorSpaces ()
     {
+      if (canonical_)
+        HPP_THROW (std::logic_error, "Canonical Lie group " << name ()
+            << " cannot be modified.");
       if (liegroupTypes_.empty()) return;
 
       LiegroupTypes newLgT;
@@ -305,6 +409,9 @@ namespace hpp {
 
     LiegroupSpacePtr_t LiegroupSpace::operator*= (const LiegroupSpaceConstPtr_t& o)
     {
+      if (canonical_)
+        HPP_THROW (std::logic_error, "Canonical Lie group " << name ()
+            << " cannot be modified.");
       liegroupTypes_.insert (liegroupTypes_.end (),
           o->liegroupTypes_.begin (),
           o->liegroupTypes_.end ());
@@ -312,6 +419,8 @@ namespace hpp {
       nvs_.insert (nvs_.end (), o->nvs_.begin (), o->nvs_.end ());
       nq_ += o->nq_;
       nv_ += o->nv_;
+      computeOperations ();
+      computeHash ();
       neutral_.conservativeResize (nq_);
       neutral_.tail (o->nq ()) = o->neutral ().vector ();
       return weak_.lock();
@@ -0,0 +1,183 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include "hpp/pinocchio/multi-center-of-mass-computation.hh"
+
+#include <boost/foreach.hpp>
+
+#include <pinocchio/multibody/model.hpp>
+#include <pinocchio/multibody/data.hpp>
+
+#include <hpp/util/exception-factory.hh>
+
+#include "hpp/pinocchio/joint.hh"
+#include "hpp/pinocchio/device.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    MultiCenterOfMassComputationPtr_t MultiCenterOfMassComputation::create
+    (const DevicePtr_t& device)
+    {
+      return MultiCenterOfMassComputationPtr_t
+        (new MultiCenterOfMassComputation (device));
+    }
+
+    MultiCenterOfMassComputation::MultiCenterOfMassComputation
+    (const DevicePtr_t& device) :
+      robot_ (device), groups_ (), joints_ ()
+    {
+      assert (device->modelPtr());
+    }
+
+    std::size_t MultiCenterOfMassComputation::addGroup ()
+    {
+      const std::size_t nj = robot_->model().joints.size();
+      Group g;
+      g.status  .assign (nj, Group::NONE);
+      g.offsets .assign (nj, 0);
+      g.masses  .assign (nj, 0);
+      g.coms    .assign (nj, vector3_t::Zero());
+      g.mass = 0;
+      g.com.setZero();
+      g.jacobian.setColumns (3, robot_->model().nv,
+                             CompactJacobian::ColumnIndexes_t ());
+      groups_.push_back (g);
+      return groups_.size() - 1;
+    }
+
+    void MultiCenterOfMassComputation::add (const std::size_t& group,
+                                            const JointPtr_t& j)
+    {
+      assert (group < groups_.size());
+      const Model& model = robot_->model();
+      const Data& data = robot_->data();
+      Group& g = groups_[group];
+
+      JointIndex jid = j->index();
+      BOOST_FOREACH( const JointIndex rootId, g.roots )
+        {
+          if( (jid >= rootId) && (data.lastChild[rootId] >= int(jid)) )
+            HPP_THROW(std::invalid_argument, "Joint " << j->name()
+                << " (" << jid << ") is already in a subtree ["
+                << rootId << ", " << data.lastChild[rootId] << "]");
+        }
+      g.roots.push_back (jid);
+
+      for (JointIndex k = jid; k <= JointIndex(data.lastChild[jid]); ++k)
+        g.status[k] = Group::MEMBER;
+      for (JointIndex k = model.parents[jid]; k > 0; k = model.parents[k])
+        if (g.status[k] == Group::NONE) g.status[k] = Group::ANCESTOR;
+
+      // Columns of the compact Jacobian
+      CompactJacobian::ColumnIndexes_t columns;
+      for (JointIndex k = 1; k < JointIndex(model.joints.size()); ++k)
+        {
+          if (g.status[k] == Group::NONE) continue;
+          const se3::JointModel& joint = model.joints[k];
+          g.offsets[k] = columns.size();
+          for (int i = 0; i < joint.nv(); ++i)
+            columns.push_back (joint.idx_v() + i);
+        }
+      g.jacobian.setColumns (3, model.nv, columns);
+
+      updateJoints ();
+    }
+
+    void MultiCenterOfMassComputation::updateJoints ()
+    {
+      const Model& model = robot_->model();
+      joints_.clear();
+      for (JointIndex k = 1; k < JointIndex(model.joints.size()); ++k)
+        {
+          for (std::size_t i = 0; i < groups_.size(); ++i)
+            if (groups_[i].status[k] != Group::NONE) {
+              joints_.push_back (k);
+              break;
+            }
+        }
+    }
+
+    void MultiCenterOfMassComputation::compute
+    (const Device::Computation_t& flag)
+    {
+      const Model& model = robot_->model();
+      const Data& data = robot_->data();
+
+      bool computeCOM = (flag & Device::COM);
+      bool computeJac = (flag & Device::JACOBIAN);
+      assert(computeCOM && "This does nothing");
+      assert (!(computeJac && !computeCOM)); // JACOBIAN => COM
+
+      for (std::size_t i = 0; i < groups_.size(); ++i)
+        {
+          Group& g = groups_[i];
+          g.masses[0] = 0;
+          g.coms  [0].setZero();
+          BOOST_FOREACH (const JointIndex jid, joints_)
+            {
+              g.masses[jid] = 0;
+              g.coms  [jid].setZero();
+            }
+        }
+
+      // Backward loop on visited joints. As joints_ is sorted, children are
+      // visited before their parent.
+      for (std::size_t k = joints_.size(); k-- > 0;)
+        {
+          const JointIndex jid = joints_[k];
+          const JointIndex parent = model.parents[jid];
+          const se3::JointModel& joint = model.joints[jid];
+
+          // Terms shared by the groups
+          const value_type& mass = model.inertias[jid].mass ();
+          const vector3_t com (mass*data.oMi[jid].act
+                               (model.inertias[jid].lever()));
+
+          for (std::size_t i = 0; i < groups_.size(); ++i)
+            {
+              Group& g = groups_[i];
+              if (g.status[jid] == Group::NONE) continue;
+              if (g.status[jid] == Group::MEMBER)
+                {
+                  g.masses[jid] += mass;
+                  g.coms  [jid] += com;
+                }
+
+              if (computeJac)
+                for (int c = 0; c < joint.nv(); ++c)
+                  {
+                    // Columns of data.J are expressed in the world frame.
+                    const size_type iv = joint.idx_v() + c;
+                    g.jacobian.matrix().col (g.offsets[jid] + c) =
+                      g.masses[jid] * data.J.col(iv).head<3>()
+                      - g.coms[jid].cross (data.J.col(iv).tail<3>());
+                  }
+
+              g.masses[parent] += g.masses[jid];
+              g.coms  [parent] += g.coms  [jid];
+            }
+        }
+
+      for (std::size_t i = 0; i < groups_.size(); ++i)
+        {
+          Group& g = groups_[i];
+          g.mass = g.masses[0];
+          g.com  = g.coms[0] / g.mass;
+          if (computeJac) g.jacobian.matrix() /= g.mass;
+        }
+    }
+  }  //  namespace pinocchio
+}  //  namespace hpp
@@ -0,0 +1,353 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/pinocchio/nearest-neighbor.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/liegroup-space.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    /// Build the splitting dimensions of an elementary Lie group.
+    struct NearestNeighbor::DimensionVisitor : public boost::static_visitor <>
+    {
+      DimensionVisitor (Dimensions_t& dims, const size_type& iq)
+        : dims_ (dims), iq_ (iq) {}
+
+      void push (DimensionType_t type, const size_type& n)
+      {
+        for (size_type i = 0; i < n; ++i) {
+          Dimension d; d.type = type; d.iq = iq_ + i;
+          dims_.push_back (d);
+        }
+      }
+
+      template <int N, bool rot>
+      void operator () (const liegroup::VectorSpaceOperation<N, rot>& lg)
+      {
+        push (EUCLIDEAN, lg.nq ());
+        iq_ += lg.nq ();
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<2>&)
+      {
+        push (ANGLE, 1);
+        iq_ += 2;
+      }
+
+      void operator () (const liegroup::SpecialOrthogonalOperation<3>&)
+      {
+        push (QUATERNION, 4);
+        iq_ += 4;
+      }
+
+      template <typename LgT1, typename LgT2>
+      void operator () (const liegroup::CartesianProductOperation<LgT1, LgT2>&)
+      {
+        (*this) (LgT1 ());
+        (*this) (LgT2 ());
+      }
+
+      // Lower bounds on the translation coordinates are valid for SE(n) as
+      // well, since the norm of the translation part of the log is greater
+      // than the norm of the translation.
+      void operator () (const se3::SpecialEuclideanOperation<2>&)
+      {
+        (*this) (liegroup::VectorSpaceOperation<2, false> ());
+        (*this) (liegroup::SpecialOrthogonalOperation<2> ());
+      }
+
+      void operator () (const se3::SpecialEuclideanOperation<3>&)
+      {
+        (*this) (liegroup::VectorSpaceOperation<3, false> ());
+        (*this) (liegroup::SpecialOrthogonalOperation<3> ());
+      }
+
+      Dimensions_t& dims_;
+      size_type iq_;
+    }; // struct DimensionVisitor
+
+    /// Sorted list of the best candidates found so far.
+    struct NearestNeighbor::Result
+    {
+      typedef std::pair<value_type, size_type> Candidate_t;
+      typedef std::vector<Candidate_t> Candidates_t;
+
+      Result (const size_type& k, const value_type& radius,
+              const value_type& eps)
+        : k_ (k), radius_ (radius), factor_ (1 + eps)
+      {
+        candidates_.reserve (std::min (k, size_type(64)));
+      }
+
+      /// Distance above which a configuration is not a candidate anymore.
+      value_type worst () const
+      {
+        if ((size_type)candidates_.size () < k_) return radius_;
+        return candidates_.back ().first;
+      }
+
+      bool prune (const value_type& bound) const
+      {
+        return factor_ * bound > worst ();
+      }
+
+      void add (const value_type& d, const size_type& i)
+      {
+        if (d > worst ()) return;
+        Candidate_t c (d, i);
+        candidates_.insert (std::upper_bound (candidates_.begin (),
+              candidates_.end (), c), c);
+        if ((size_type)candidates_.size () > k_) candidates_.pop_back ();
+      }
+
+      size_type k_;
+      value_type radius_, factor_;
+      Candidates_t candidates_;
+    }; // struct Result
+
+    NearestNeighborPtr_t NearestNeighbor::create (const DevicePtr_t& robot,
+        const size_type& bucketSize)
+    {
+      return NearestNeighborPtr_t (new NearestNeighbor (robot, bucketSize));
+    }
+
+    NearestNeighbor::NearestNeighbor (const DevicePtr_t& robot,
+        const size_type& bucketSize)
+      : robot_ (robot), bucketSize_ (bucketSize), dimensions_ (), nodes_ (),
+      configs_ (), nConfigs_ (0)
+    {
+      assert (bucketSize_ > 0);
+      computeDimensions ();
+      clear ();
+    }
+
+    void NearestNeighbor::computeDimensions ()
+    {
+      const LiegroupSpacePtr_t& space (robot_->configSpace ());
+      dimensions_.clear ();
+      DimensionVisitor visitor (dimensions_, 0);
+      for (std::size_t i = 0; i < space->liegroupTypes ().size (); ++i)
+        boost::apply_visitor (visitor, space->liegroupTypes () [i]);
+      assert (visitor.iq_ == robot_->configSize ());
+    }
+
+    void NearestNeighbor::clear ()
+    {
+      nodes_.clear ();
+      Node root; root.dim = -1; root.split = 0; root.left = root.right = -1;
+      nodes_.push_back (root);
+      configs_.resize (robot_->configSize (), 0);
+      nConfigs_ = 0;
+    }
+
+    value_type NearestNeighbor::coordinate (ConfigurationIn_t q,
+        const Dimension& d) const
+    {
+      switch (d.type) {
+        case ANGLE:
+          return std::atan2 (q [d.iq + 1], q [d.iq]);
+        case EUCLIDEAN:
+        case QUATERNION:
+        default:
+          return q [d.iq];
+      }
+    }
+
+    value_type NearestNeighbor::lowerBound (const value_type& x,
+        const Node& node, const bool upperSide) const
+    {
+      const value_type& s (node.split);
+      switch (dimensions_ [node.dim].type) {
+        case ANGLE:
+          // Angles lie in [-pi, pi]. The distance between two angles is
+          // computed modulo 2pi.
+          if (upperSide) {
+            if (x >= s) return 0;
+            return std::min (s - x, x + M_PI);
+          } else {
+            if (x < s) return 0;
+            return std::min (x - s, M_PI - x);
+          }
+        case QUATERNION:
+          {
+            // q and -q represent the same rotation. The rotation angle
+            // between two rotations is greater than twice the smallest
+            // chord between the two pairs of quaternions.
+            value_type chord;
+            if (upperSide)
+              chord = std::min (std::max (value_type(0), s - x),
+                                std::max (value_type(0), x + s));
+            else
+              chord = std::min (std::max (value_type(0), x - s),
+                                std::max (value_type(0), - x - s));
+            return 2 * chord;
+          }
+        case EUCLIDEAN:
+        default:
+          if (upperSide) return std::max (value_type(0), s - x);
+          else           return std::max (value_type(0), x - s);
+      }
+    }
+
+    size_type NearestNeighbor::add (ConfigurationIn_t q)
+    {
+      assert (q.size () == robot_->configSize ());
+      if (nConfigs_ == configs_.cols ())
+        configs_.conservativeResize (configs_.rows (),
+            std::max (size_type(16), 2 * configs_.cols ()));
+      const size_type index = nConfigs_;
+      configs_.col (index) = q;
+      ++nConfigs_;
+
+      // Go down to the leaf.
+      size_type node = 0;
+      while (nodes_ [node].dim >= 0) {
+        const Node& n (nodes_ [node]);
+        if (coordinate (q, dimensions_ [n.dim]) < n.split) node = n.left;
+        else                                               node = n.right;
+      }
+      nodes_ [node].points.push_back (index);
+      if ((size_type)nodes_ [node].points.size () > bucketSize_)
+        splitLeaf (node);
+      return index;
+    }
+
+    void NearestNeighbor::splitLeaf (const size_type& node)
+    {
+      const Indexes_t& points (nodes_ [node].points);
+      const std::size_t n (points.size ());
+      std::vector<value_type> values (n);
+
+      // Select the dimension of largest spread.
+      size_type bestDim = -1;
+      value_type bestSpread = 0;
+      for (std::size_t d = 0; d < dimensions_.size (); ++d) {
+        value_type vmin = std::numeric_limits<value_type>::infinity (),
+                   vmax = - std::numeric_limits<value_type>::infinity ();
+        for (std::size_t i = 0; i < n; ++i) {
+          const value_type x (coordinate (configs_.col (points [i]),
+                dimensions_ [d]));
+          vmin = std::min (vmin, x);
+          vmax = std::max (vmax, x);
+        }
+        if (vmax - vmin > bestSpread) {
+          bestSpread = vmax - vmin;
+          bestDim = (size_type)d;
+        }
+      }
+      // All configurations are identical: keep a larger leaf.
+      if (bestDim < 0) return;
+
+      for (std::size_t i = 0; i < n; ++i)
+        values [i] = coordinate (configs_.col (points [i]),
+            dimensions_ [bestDim]);
+      std::sort (values.begin (), values.end ());
+      value_type split = values [n / 2];
+      if (split == values.front ())
+        split = .5 * (values.front () + values.back ());
+
+      Node left, right;
+      left.dim = right.dim = -1;
+      left.split = right.split = 0;
+      left.left = left.right = right.left = right.right = -1;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (coordinate (configs_.col (points [i]), dimensions_ [bestDim])
+            < split)
+          left .points.push_back (points [i]);
+        else
+          right.points.push_back (points [i]);
+      }
+      // The split may not separate the configurations, for instance if the
+      // midpoint of two consecutive floating point values rounds to one of
+      // them: keep a larger leaf.
+      if (left.points.empty () || right.points.empty ()) return;
+
+      const size_type iLeft = (size_type) nodes_.size ();
+      nodes_.push_back (left);
+      nodes_.push_back (right);
+      Node& parent (nodes_ [node]);
+      parent.dim = bestDim;
+      parent.split = split;
+      parent.left = iLeft;
+      parent.right = iLeft + 1;
+      Indexes_t ().swap (parent.points);
+    }
+
+    void NearestNeighbor::recursiveSearch (const size_type& node,
+        ConfigurationIn_t q, Result& result) const
+    {
+      const Node& n (nodes_ [node]);
+      if (n.dim < 0) {
+        for (std::size_t i = 0; i < n.points.size (); ++i) {
+          const size_type& p (n.points [i]);
+          result.add (distance (robot_, q, configs_.col (p)), p);
+        }
+        return;
+      }
+      const value_type x (coordinate (q, dimensions_ [n.dim]));
+      const bool upper (x >= n.split);
+      recursiveSearch (upper ? n.right : n.left, q, result);
+      if (!result.prune (lowerBound (x, n, !upper)))
+        recursiveSearch (upper ? n.left : n.right, q, result);
+    }
+
+    size_type NearestNeighbor::search (ConfigurationIn_t q,
+        value_type& distance, const value_type& eps) const
+    {
+      Result result (1, std::numeric_limits<value_type>::infinity (), eps);
+      recursiveSearch (0, q, result);
+      if (result.candidates_.empty ()) {
+        distance = std::numeric_limits<value_type>::infinity ();
+        return -1;
+      }
+      distance = result.candidates_.front ().first;
+      return result.candidates_.front ().second;
+    }
+
+    void NearestNeighbor::search (ConfigurationIn_t q, const size_type& k,
+        Indexes_t& indexes, Distances_t& distances, const value_type& eps) const
+    {
+      Result result (k, std::numeric_limits<value_type>::infinity (), eps);
+      recursiveSearch (0, q, result);
+      indexes  .resize (result.candidates_.size ());
+      distances.resize (result.candidates_.size ());
+      for (std::size_t i = 0; i < result.candidates_.size (); ++i) {
+        distances [i] = result.candidates_ [i].first;
+        indexes   [i] = result.candidates_ [i].second;
+      }
+    }
+
+    void NearestNeighbor::withinBall (ConfigurationIn_t q,
+        const value_type& radius, Indexes_t& indexes,
+        Distances_t& distances) const
+    {
+      Result result (std::numeric_limits<size_type>::max (), radius, 0);
+      recursiveSearch (0, q, result);
+      indexes  .resize (result.candidates_.size ());
+      distances.resize (result.candidates_.size ());
+      for (std::size_t i = 0; i < result.candidates_.size (); ++i) {
+        distances [i] = result.candidates_ [i].first;
+        indexes   [i] = result.candidates_ [i].second;
+      }
+    }
+  } // namespace pinocchio
+} // namespace hpp
@@ -17,6 +17,8 @@
 #ifndef HPP_PINOCCHIO_SRC_SIZE_VISITOR_HH
 # define HPP_PINOCCHIO_SRC_SIZE_VISITOR_HH
 
+# include <boost/functional/hash.hpp>
+
 namespace hpp {
   namespace pinocchio {
     namespace liegroupType {
@@ -57,6 +59,30 @@ namespace hpp {
         bool isVectorSpace;
       }; // struct SizeVisitor
 
+      /// Visitor to combine the hash of a LiegroupType with a seed
+      ///
+      /// Vector spaces of the same size are equal whether their size is
+      /// static or dynamic. Their hash thus depends only on their size.
+      /// The hash of other types depends on their index in the variant.
+      struct HashVisitor : public boost::static_visitor <>
+      {
+        HashVisitor (std::size_t& seed, const int& which)
+          : seed_ (seed), which_ (which) {}
+
+        template <typename LiegroupType> void operator () (const LiegroupType&)
+        {
+          boost::hash_combine (seed_, which_);
+        }
+        template<int Size, bool rot>
+        void operator () (const liegroup::VectorSpaceOperation<Size,rot>& op)
+        {
+          boost::hash_combine (seed_, rot ? -1 : -2);
+          boost::hash_combine (seed_, op.nq ());
+        }
+        std::size_t& seed_;
+        int which_;
+      }; // struct HashVisitor
+
 
     } // namespace liegroupType
   } // namespace pinocchio
@@ -0,0 +1,243 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "hpp/pinocchio/sphere-approximation.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <hpp/fcl/BV/OBBRSS.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+
+#include <pinocchio/multibody/model.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+#include <pinocchio/algorithm/geometry.hpp>
+
+#include "hpp/pinocchio/device.hh"
+
+#include "bounding-sphere.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    using details::toVector3;
+
+    namespace {
+      typedef fcl::BVHModel<fcl::OBBRSS> Polyhedron_t;
+    } // namespace
+
+    SphereApproximationPtr_t SphereApproximation::create
+    (const DevicePtr_t& device, const size_type& spheresPerMesh)
+    {
+      return SphereApproximationPtr_t
+        (new SphereApproximation (device, spheresPerMesh));
+    }
+
+    SphereApproximation::SphereApproximation
+    (const DevicePtr_t& device, const size_type& spheresPerMesh) :
+      robot_ (device), spheresPerMesh_ (spheresPerMesh),
+      localCenters_ (3, 0), centers_ (3, 0), radii_ (0),
+      begin_ (), approximated_ (), bodyRadii_ ()
+    {
+      assert (spheresPerMesh > 0);
+      build ();
+    }
+
+    void SphereApproximation::build ()
+    {
+      const Model& model = robot_->model();
+      const GeomModel& geomModel = robot_->geomModel();
+      const GeomData& geomData = robot_->geomData();
+
+      localCenters_.resize (3, 0);
+      radii_.resize (0);
+      bodyRadii_.resize (model.joints.size());
+      for (std::size_t j = 0; j < model.joints.size(); ++j)
+        bodyRadii_[j] = (j < geomData.radius.size() ? geomData.radius[j] : 0);
+
+      const std::size_t n = geomModel.geometryObjects.size();
+      begin_.resize (n + 1);
+      approximated_.assign (n, true);
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          begin_[i] = size();
+          const se3::GeometryObject& go (geomModel.geometryObjects[i]);
+          const fcl::CollisionGeometry& g (*go.fcl);
+
+          const value_type radius (details::primitiveRadius (g));
+          if (radius >= 0) {
+            addSphere (vector3_t::Zero(), radius);
+          } else {
+            const Polyhedron_t* mesh = dynamic_cast<const Polyhedron_t*> (&g);
+            if (mesh == NULL || mesh->num_tris == 0) {
+              approximated_[i] = false;
+              continue;
+            }
+
+            // Cut the mesh along the largest dimension of its bounding box.
+            vector3_t lower (toVector3 (mesh->vertices[0])), upper (lower);
+            for (int k = 1; k < mesh->num_vertices; ++k) {
+              lower = lower.cwiseMin (toVector3 (mesh->vertices[k]));
+              upper = upper.cwiseMax (toVector3 (mesh->vertices[k]));
+            }
+            int axis;
+            const value_type length ((upper - lower).maxCoeff (&axis));
+            const size_type nSlices
+              (std::min (spheresPerMesh_, size_type (mesh->num_tris)));
+
+            std::vector<vector3_t> sliceLower (nSlices,
+                vector3_t::Constant (+std::numeric_limits<value_type>::infinity()));
+            std::vector<vector3_t> sliceUpper (nSlices,
+                vector3_t::Constant (-std::numeric_limits<value_type>::infinity()));
+            std::vector<size_type> slices (mesh->num_tris);
+            for (int t = 0; t < mesh->num_tris; ++t) {
+              const fcl::Triangle& tri (mesh->tri_indices[t]);
+              value_type c = 0;
+              for (int k = 0; k < 3; ++k)
+                c += mesh->vertices[tri[k]][axis];
+              size_type s (length > 0 ?
+                  size_type (nSlices * (c / 3 - lower[axis]) / length) : 0);
+              s = std::max (size_type (0), std::min (s, nSlices - 1));
+              slices[t] = s;
+              for (int k = 0; k < 3; ++k) {
+                const vector3_t v (toVector3 (mesh->vertices[tri[k]]));
+                sliceLower[s] = sliceLower[s].cwiseMin (v);
+                sliceUpper[s] = sliceUpper[s].cwiseMax (v);
+              }
+            }
+
+            // Center each sphere on the bounding box of its slice and make
+            // it contain the vertices of the triangles of the slice.
+            std::vector<vector3_t> centers (nSlices);
+            std::vector<value_type> radii (nSlices, -1);
+            for (size_type s = 0; s < nSlices; ++s)
+              centers[s] = (sliceLower[s] + sliceUpper[s]) / 2;
+            for (int t = 0; t < mesh->num_tris; ++t) {
+              const size_type s (slices[t]);
+              const fcl::Triangle& tri (mesh->tri_indices[t]);
+              for (int k = 0; k < 3; ++k)
+                radii[s] = std::max (radii[s], (toVector3
+                      (mesh->vertices[tri[k]]) - centers[s]).norm());
+            }
+            for (size_type s = 0; s < nSlices; ++s)
+              if (radii[s] >= 0) addSphere (centers[s], radii[s]);
+          }
+
+          // The body radius must cover the spheres.
+          const JointIndex j (go.parentJoint);
+          for (size_type k = begin_[i]; k < size(); ++k)
+            bodyRadii_[j] = std::max (bodyRadii_[j],
+                (go.placement.act (vector3_t (localCenters_.col(k)))).norm()
+                + radii_[k]);
+        }
+      begin_[n] = size();
+      centers_.resize (3, size());
+    }
+
+    void SphereApproximation::addSphere (const vector3_t& center,
+                                         const value_type& radius)
+    {
+      const size_type k = size();
+      localCenters_.conservativeResize (3, k + 1);
+      radii_.conservativeResize (k + 1);
+      localCenters_.col(k) = center;
+      radii_[k] = radius;
+    }
+
+    void SphereApproximation::compute ()
+    {
+      const Data& data = robot_->data();
+      const GeomModel& geomModel = robot_->geomModel();
+      // Geometries added since the spheres were built
+      if (begin_.size() != geomModel.geometryObjects.size() + 1) build ();
+      for (std::size_t i = 0; i + 1 < begin_.size(); ++i)
+        {
+          const size_type n (begin_[i+1] - begin_[i]);
+          if (n == 0) continue;
+          const se3::GeometryObject& go (geomModel.geometryObjects[i]);
+          const Transform3f M (data.oMi[go.parentJoint] * go.placement);
+          centers_.middleCols (begin_[i], n).noalias() =
+            M.rotation() * localCenters_.middleCols (begin_[i], n);
+          centers_.middleCols (begin_[i], n).colwise() += M.translation();
+        }
+    }
+
+    bool SphereApproximation::overlap (const std::size_t& pairIndex) const
+    {
+      const GeomModel& geomModel = robot_->geomModel();
+      const se3::CollisionPair& pair (geomModel.collisionPairs[pairIndex]);
+      // Geometries added after the last call to compute are tested with
+      // the exact geometries.
+      if (pair.first  >= approximated_.size() || !approximated_[pair.first ]
+          || pair.second >= approximated_.size() || !approximated_[pair.second])
+        return true;
+
+      // Coarsest level: bodies. Obstacles attached to the universe may be
+      // moved and are not tested at this level.
+      const JointIndex j1 (geomModel.geometryObjects[pair.first ].parentJoint),
+                       j2 (geomModel.geometryObjects[pair.second].parentJoint);
+      if (j1 != 0 && j2 != 0) {
+        const Data& data = robot_->data();
+        const value_type r (bodyRadii_[j1] + bodyRadii_[j2]);
+        if ((data.oMi[j1].translation() - data.oMi[j2].translation())
+            .squaredNorm() > r * r)
+          return false;
+      }
+
+      // Spheres of the objects. The spheres of the second object are
+      // tested together against each sphere of the first one. The
+      // expression is evaluated lazily by any(), without temporary.
+      const size_type b2 (begin_[pair.second]),
+                      n2 (begin_[pair.second+1] - b2);
+      for (size_type k = begin_[pair.first]; k < begin_[pair.first+1]; ++k)
+        {
+          if ((  (centers_.row(0).segment(b2, n2).array() - centers_(0,k)).square()
+               + (centers_.row(1).segment(b2, n2).array() - centers_(1,k)).square()
+               + (centers_.row(2).segment(b2, n2).array() - centers_(2,k)).square()
+               <= (radii_.segment(b2, n2).transpose().array() + radii_[k])
+               .square()).any())
+            return true;
+        }
+      return false;
+    }
+
+    bool SphereApproximation::collisionTest (const bool stopAtFirstCollision)
+    {
+      const GeomModel& geomModel = robot_->geomModel();
+      GeomData& geomData = robot_->geomData();
+      bool placed = false, isColliding = false;
+      for (std::size_t cp = 0; cp < geomModel.collisionPairs.size(); ++cp)
+        {
+          if (!geomData.activeCollisionPairs[cp]) continue;
+          if (!overlap (cp)) {
+            geomData.collisionResults[cp].clear();
+            continue;
+          }
+          // Place the geometries only if an exact test is needed.
+          if (!placed) {
+            robot_->updateGeometryPlacements();
+            placed = true;
+          }
+          se3::computeCollision (geomModel, geomData, cp);
+          isColliding |= geomData.collisionResults[cp].isCollision();
+          if (isColliding && stopAtFirstCollision) return true;
+        }
+      return isColliding;
+    }
+  }  //  namespace pinocchio
+}  //  namespace hpp
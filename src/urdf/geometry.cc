@@ -0,0 +1,361 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include "geometry.hh"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/mesh_loader/assimp.h>
+
+#include <pinocchio/parsers/utils.hpp>
+
+#include <hpp/util/debug.hh>
+#include <hpp/util/exception-factory.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    namespace urdf {
+      namespace details {
+        namespace {
+          Transform3f toTransform3f (const ::urdf::Pose& pose)
+          {
+            const ::urdf::Rotation& r = pose.rotation;
+            const ::urdf::Vector3& p = pose.position;
+            Eigen::Quaternion <value_type> quat (r.w, r.x, r.y, r.z);
+            return Transform3f (quat.matrix (), vector3_t (p.x, p.y, p.z));
+          }
+
+          void parseLink (const ::urdf::LinkConstSharedPtr& link,
+                          const Model& model,
+                          const std::vector <std::string>& baseDirs,
+                          GeometryDescriptions_t& descriptions)
+          {
+            if (!link->collision_array.empty ()) {
+              const se3::FrameIndex frame =
+                model.getFrameId (link->name, se3::BODY);
+              const se3::Frame& f = model.frames[frame];
+
+              std::size_t rank = 0;
+              BOOST_FOREACH (const ::urdf::CollisionSharedPtr& collision,
+                             link->collision_array) {
+                GeometryDescription d;
+                std::ostringstream oss;
+                oss << link->name << "_" << rank++;
+                d.name = oss.str ();
+                d.frame = frame;
+                d.joint = f.parent;
+                d.placement = f.placement * toTransform3f (collision->origin);
+                d.geometry = collision->geometry;
+                d.meshScale.setOnes ();
+                switch (d.geometry->type) {
+                  case ::urdf::Geometry::MESH: {
+                    const ::urdf::Mesh& mesh =
+                      static_cast <const ::urdf::Mesh&> (*d.geometry);
+                    d.meshPath = se3::retrieveResourcePath (mesh.filename,
+                                                            baseDirs);
+                    if (d.meshPath.empty ())
+                      HPP_THROW (std::invalid_argument, "Mesh "
+                          << mesh.filename << " of link " << link->name
+                          << " could not be found.");
+                    d.meshScale << mesh.scale.x, mesh.scale.y, mesh.scale.z;
+                    break;
+                  }
+                  case ::urdf::Geometry::BOX     : d.meshPath = "BOX"     ; break;
+                  case ::urdf::Geometry::CYLINDER: d.meshPath = "CYLINDER"; break;
+                  case ::urdf::Geometry::SPHERE  : d.meshPath = "SPHERE"  ; break;
+                  default:
+                    HPP_THROW (std::invalid_argument, "Unknown geometry type"
+                        " in link " << link->name);
+                }
+                descriptions.push_back (d);
+              }
+            }
+            BOOST_FOREACH (const ::urdf::LinkConstSharedPtr& child,
+                           link->child_links)
+              parseLink (child, model, baseDirs, descriptions);
+          }
+
+          /// Registry of shared meshes
+          struct MeshRegistry
+          {
+            struct Key
+            {
+              std::string path;
+              value_type scale[3];
+
+              Key (const std::string& p, const vector3_t& s) : path (p)
+              {
+                scale[0] = s[0]; scale[1] = s[1]; scale[2] = s[2];
+              }
+              bool operator< (const Key& other) const
+              {
+                if (path != other.path) return path < other.path;
+                return std::lexicographical_compare (scale, scale + 3,
+                    other.scale, other.scale + 3);
+              }
+            }; // struct Key
+            typedef boost::weak_ptr <fcl::CollisionGeometry> WkPtr_t;
+            typedef std::map <Key, WkPtr_t> Meshes_t;
+
+            boost::mutex mutex;
+            Meshes_t meshes;
+          }; // struct MeshRegistry
+
+          MeshRegistry& meshRegistry ()
+          {
+            static MeshRegistry r;
+            return r;
+          }
+
+          /// Load geometries from a queue of descriptions
+          struct LoadWorker
+          {
+            const GeometryDescriptions_t& descriptions;
+            const std::vector <std::size_t>& queue;
+            CollisionGeometries_t& geometries;
+            std::vector <boost::exception_ptr>& errors;
+            boost::mutex& mutex;
+            std::size_t& next;
+
+            void operator() () const
+            {
+              while (true) {
+                std::size_t k;
+                {
+                  boost::mutex::scoped_lock lock (mutex);
+                  if (next >= queue.size ()) return;
+                  k = next++;
+                }
+                const std::size_t i = queue[k];
+                try {
+                  geometries[i] = loadGeometry (descriptions[i]);
+                } catch (...) {
+                  errors[i] = boost::current_exception ();
+                }
+              }
+            }
+          }; // struct LoadWorker
+        } // namespace
+
+        CollisionGeometryPtr_t findSharedMesh (const std::string& path,
+                                               const vector3_t& scale)
+        {
+          MeshRegistry& r (meshRegistry ());
+          boost::mutex::scoped_lock lock (r.mutex);
+          MeshRegistry::Meshes_t::iterator it
+            (r.meshes.find (MeshRegistry::Key (path, scale)));
+          if (it == r.meshes.end ()) return CollisionGeometryPtr_t ();
+          CollisionGeometryPtr_t mesh (it->second.lock ());
+          // The mesh has been deleted.
+          if (!mesh) r.meshes.erase (it);
+          return mesh;
+        }
+
+        CollisionGeometryPtr_t shareMesh (const std::string& path,
+                                          const vector3_t& scale,
+                                          const CollisionGeometryPtr_t& mesh)
+        {
+          MeshRegistry& r (meshRegistry ());
+          boost::mutex::scoped_lock lock (r.mutex);
+          MeshRegistry::WkPtr_t& wk (r.meshes[MeshRegistry::Key (path, scale)]);
+          CollisionGeometryPtr_t registered (wk.lock ());
+          if (registered) return registered;
+          wk = mesh;
+          return mesh;
+        }
+
+        void parseGeometries (const ::urdf::ModelInterfaceSharedPtr& urdfTree,
+                              const Model& model,
+                              const std::vector <std::string>& baseDirs,
+                              GeometryDescriptions_t& descriptions)
+        {
+          if (urdfTree)
+            parseLink (urdfTree->getRoot (), model, baseDirs, descriptions);
+        }
+
+        CollisionGeometryPtr_t loadGeometry
+        (const GeometryDescription& d)
+        {
+          const ::urdf::Geometry& g = *d.geometry;
+          switch (g.type) {
+            case ::urdf::Geometry::MESH: {
+              CollisionGeometryPtr_t mesh (findSharedMesh (d.meshPath,
+                                                           d.meshScale));
+              if (mesh) return mesh;
+              // Load the mesh without holding the lock of the registry.
+              PolyhedronPtr_t polyhedron (new Polyhedron_t);
+              fcl::Vec3f scale (d.meshScale[0], d.meshScale[1],
+                                d.meshScale[2]);
+              fcl::loadPolyhedronFromResource (d.meshPath, scale, polyhedron);
+              return shareMesh (d.meshPath, d.meshScale, polyhedron);
+            }
+            case ::urdf::Geometry::BOX: {
+              const ::urdf::Vector3& dim =
+                static_cast <const ::urdf::Box&> (g).dim;
+              return CollisionGeometryPtr_t (new fcl::Box (dim.x, dim.y, dim.z));
+            }
+            case ::urdf::Geometry::CYLINDER: {
+              const ::urdf::Cylinder& c = static_cast <const ::urdf::Cylinder&> (g);
+              return CollisionGeometryPtr_t (new fcl::Cylinder (c.radius, c.length));
+            }
+            case ::urdf::Geometry::SPHERE: {
+              const ::urdf::Sphere& s = static_cast <const ::urdf::Sphere&> (g);
+              return CollisionGeometryPtr_t (new fcl::Sphere (s.radius));
+            }
+            default:
+              throw std::invalid_argument ("Unknown geometry type");
+          }
+        }
+
+        void loadGeometries (const GeometryDescriptions_t& descriptions,
+                             CollisionGeometries_t& geometries,
+                             std::size_t nThreads)
+        {
+          const std::size_t n = descriptions.size ();
+          geometries.assign (n, CollisionGeometryPtr_t ());
+
+          // Each mesh is loaded by the first description that uses it.
+          std::vector <std::size_t> source (n), queue;
+          std::map <MeshRegistry::Key, std::size_t> first;
+          for (std::size_t i = 0; i < n; ++i) {
+            const GeometryDescription& d = descriptions[i];
+            source[i] = i;
+            if (!d.isMesh ()) {
+              queue.push_back (i);
+              continue;
+            }
+            std::pair <std::map <MeshRegistry::Key, std::size_t>::iterator, bool>
+              res (first.insert (std::make_pair
+                    (MeshRegistry::Key (d.meshPath, d.meshScale), i)));
+            if (res.second) queue.push_back (i);
+            else source[i] = res.first->second;
+          }
+
+          std::vector <boost::exception_ptr> errors (n);
+          boost::mutex mutex;
+          std::size_t next = 0;
+          LoadWorker worker = { descriptions, queue, geometries, errors,
+            mutex, next };
+
+          if (nThreads == 0) nThreads = boost::thread::hardware_concurrency ();
+          nThreads = std::min (nThreads, queue.size ());
+          if (nThreads <= 1) {
+            worker ();
+          } else {
+            boost::thread_group threads;
+            for (std::size_t t = 0; t < nThreads; ++t)
+              threads.create_thread (worker);
+            threads.join_all ();
+          }
+
+          for (std::size_t i = 0; i < n; ++i)
+            if (errors[source[i]]) boost::rethrow_exception (errors[source[i]]);
+          for (std::size_t i = 0; i < n; ++i)
+            geometries[i] = geometries[source[i]];
+        }
+
+        void addGeometries (const Model& model,
+                            const GeometryDescriptions_t& descriptions,
+                            const CollisionGeometries_t& geometries,
+                            GeomModel& geomModel)
+        {
+          assert (descriptions.size () == geometries.size ());
+          for (std::size_t i = 0; i < descriptions.size (); ++i) {
+            const GeometryDescription& d = descriptions[i];
+            geomModel.addGeometryObject (se3::GeometryObject (d.name, d.frame,
+                  d.joint, geometries[i], d.placement, d.meshPath,
+                  d.meshScale), model);
+          }
+        }
+
+        void parseDisabledCollisions (const std::string& srdf,
+                                      const Model& model,
+                                      FramePairs_t& disabled)
+        {
+          namespace ptree = boost::property_tree;
+          ptree::ptree tree;
+          std::istringstream iss (srdf);
+          ptree::read_xml (iss, tree, ptree::xml_parser::no_comments);
+
+          BOOST_FOREACH (const ptree::ptree::value_type& v,
+                         tree.get_child ("robot")) {
+            if (v.first != "disable_collisions") continue;
+            const std::string link1 =
+              v.second.get <std::string> ("<xmlattr>.link1");
+            const std::string link2 =
+              v.second.get <std::string> ("<xmlattr>.link2");
+            if (!model.existBodyName (link1) || !model.existBodyName (link2)) {
+              hppDout (info, "Link " << link1 << " or " << link2
+                  << " not found, cannot disable collisions between them.");
+              continue;
+            }
+            disabled.push_back (FramePair_t (model.getBodyId (link1),
+                                             model.getBodyId (link2)));
+          }
+        }
+
+        void buildCollisionPairs (const GeometryDescriptions_t& descriptions,
+                                  const FramePairs_t& disabled,
+                                  CollisionPairs_t& pairs)
+        {
+          const std::size_t n = descriptions.size ();
+
+          // Index the links that have geometries.
+          typedef std::map <se3::FrameIndex, std::size_t> LinkIndexes_t;
+          LinkIndexes_t linkIndexes;
+          std::vector <std::size_t> links (n);
+          for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t index = linkIndexes.size ();
+            links[i] = linkIndexes.insert (std::make_pair
+                (descriptions[i].frame, index)).first->second;
+          }
+
+          // Bit matrix of the excluded link pairs
+          const std::size_t nl = linkIndexes.size ();
+          std::vector <bool> excluded (nl * nl, false);
+          BOOST_FOREACH (const FramePair_t& p, disabled) {
+            LinkIndexes_t::const_iterator l1 (linkIndexes.find (p.first )),
+                                          l2 (linkIndexes.find (p.second));
+            // Links without geometry
+            if (l1 == linkIndexes.end () || l2 == linkIndexes.end ()) continue;
+            excluded[l1->second * nl + l2->second] = true;
+            excluded[l2->second * nl + l1->second] = true;
+          }
+
+          pairs.clear ();
+          for (std::size_t i = 0; i < n; ++i) {
+            const std::vector <bool>::const_iterator row
+              (excluded.begin () + links[i] * nl);
+            for (std::size_t j = i + 1; j < n; ++j) {
+              if (descriptions[i].joint == descriptions[j].joint) continue;
+              if (row[links[j]]) continue;
+              pairs.push_back (se3::CollisionPair (i, j));
+            }
+          }
+        }
+      } // namespace details
+    } // namespace urdf
+  } // namespace pinocchio
+} // namespace hpp
@@ -0,0 +1,165 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_SRC_URDF_GEOMETRY_HH
+# define HPP_PINOCCHIO_SRC_URDF_GEOMETRY_HH
+
+# include <string>
+# include <vector>
+
+# include <urdf_model/model.h>
+
+# include <hpp/fcl/BVH/BVH_model.h>
+# include <hpp/fcl/BV/OBBRSS.h>
+
+# include <pinocchio/multibody/model.hpp>
+# include <pinocchio/multibody/geometry.hpp>
+
+# include <hpp/pinocchio/fwd.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    namespace urdf {
+      namespace details {
+        typedef boost::shared_ptr <fcl::CollisionGeometry>
+          CollisionGeometryPtr_t;
+        typedef fcl::BVHModel <fcl::OBBRSS> Polyhedron_t;
+        typedef boost::shared_ptr <Polyhedron_t> PolyhedronPtr_t;
+        typedef std::vector <CollisionGeometryPtr_t> CollisionGeometries_t;
+        typedef std::vector <se3::CollisionPair> CollisionPairs_t;
+        typedef std::pair <se3::FrameIndex, se3::FrameIndex> FramePair_t;
+        typedef std::vector <FramePair_t> FramePairs_t;
+
+        /// Collision element of a link of a URDF model
+        ///
+        /// This is what se3::urdf::buildGeom reads from the URDF model, before
+        /// loading the meshes.
+        struct GeometryDescription
+        {
+          /// Name of the geometry object: link name followed by the rank
+          /// of the collision element in the link.
+          std::string name;
+          se3::FrameIndex frame;
+          JointIndex joint;
+          /// Placement in the parent joint frame
+          Transform3f placement;
+          /// The URDF geometry
+          ::urdf::GeometrySharedPtr geometry;
+          /// Absolute path of the mesh, or the name of the primitive
+          /// ("BOX", "CYLINDER", "SPHERE").
+          std::string meshPath;
+          vector3_t meshScale;
+
+          bool isMesh () const
+          {
+            return geometry->type == ::urdf::Geometry::MESH;
+          }
+        }; // struct GeometryDescription
+        typedef std::vector <GeometryDescription> GeometryDescriptions_t;
+
+        /// Read the collision elements of all links of a URDF model
+        ///
+        /// Links are visited depth first, in the order of
+        /// se3::urdf::buildGeom, so that the geometry objects have the same
+        /// indices.
+        /// \param model the kinematic model built from urdfTree,
+        /// \param baseDirs directories where package:// resources are
+        ///        searched,
+        /// \throw std::invalid_argument if a mesh cannot be found.
+        void parseGeometries (const ::urdf::ModelInterfaceSharedPtr& urdfTree,
+                              const Model& model,
+                              const std::vector <std::string>& baseDirs,
+                              GeometryDescriptions_t& descriptions);
+
+        /// Load the mesh or create the primitive of a collision element
+        ///
+        /// Meshes are shared: if a mesh with the same path and scale is
+        /// already used, it is returned instead of being loaded again.
+        CollisionGeometryPtr_t loadGeometry
+        (const GeometryDescription& description);
+
+        /// Load the geometries of all collision elements
+        ///
+        /// Meshes are imported and their BVH built in parallel, each mesh
+        /// being loaded once even if it is used by several elements.
+        /// \param nThreads number of threads. 0 means as many as the
+        ///        hardware supports.
+        /// \retval geometries the geometry of descriptions[i] is stored at
+        ///         index i, independently of the order of loading.
+        /// \throw the exception thrown by loadGeometry for the first
+        ///        description, in the order of descriptions, that failed.
+        void loadGeometries (const GeometryDescriptions_t& descriptions,
+                             CollisionGeometries_t& geometries,
+                             std::size_t nThreads = 0);
+
+        /// \name Process-wide registry of meshes
+        ///
+        /// The registry holds weak pointers, keyed by mesh path and scale,
+        /// so that a mesh is freed when the last geometry object that uses
+        /// it is deleted.
+        /// \warning meshes must not be modified, as they may be shared by
+        ///          several geometry objects and devices.
+        /// \{
+
+        /// Find a mesh in the registry
+        /// \return an empty pointer if the mesh is not registered.
+        CollisionGeometryPtr_t findSharedMesh (const std::string& path,
+                                               const vector3_t& scale);
+
+        /// Register a mesh
+        /// \return the registered mesh, which is not mesh if another thread
+        ///         registered the same mesh in the meantime.
+        CollisionGeometryPtr_t shareMesh (const std::string& path,
+                                          const vector3_t& scale,
+                                          const CollisionGeometryPtr_t& mesh);
+        /// \}
+
+        /// Add the geometry objects to a geometry model
+        /// \param geometries the collision geometries, in the order of
+        ///        descriptions.
+        void addGeometries (const Model& model,
+                            const GeometryDescriptions_t& descriptions,
+                            const CollisionGeometries_t& geometries,
+                            GeomModel& geomModel);
+
+        /// Read the disable_collisions elements of a SRDF description
+        ///
+        /// Links that are not in the model are ignored.
+        /// \param srdf the content of the SRDF file.
+        /// \retval disabled the pairs of body frames between which
+        ///         collisions are disabled.
+        void parseDisabledCollisions (const std::string& srdf,
+                                      const Model& model,
+                                      FramePairs_t& disabled);
+
+        /// Build the collision pairs of the geometries of a model
+        ///
+        /// Pairs of geometries attached to the same joint, or to links
+        /// between which collisions are disabled, are excluded. The excluded
+        /// link pairs are stored in a bit matrix indexed by the links that
+        /// have geometries, so that the allowed pairs are emitted directly
+        /// instead of removing pairs from the list of all pairs.
+        /// \retval pairs pairs (i, j) of indices in descriptions, with
+        ///         i < j, in lexicographic order.
+        void buildCollisionPairs (const GeometryDescriptions_t& descriptions,
+                                  const FramePairs_t& disabled,
+                                  CollisionPairs_t& pairs);
+      } // namespace details
+    } // namespace urdf
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_SRC_URDF_GEOMETRY_HH
@@ -0,0 +1,365 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#include "model-cache.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <hpp/util/debug.hh>
+
+#include <hpp/pinocchio/urdf/util.hh>
+
+namespace hpp {
+  namespace pinocchio {
+    namespace urdf {
+      namespace {
+        struct CacheDirectory
+        {
+          boost::mutex mutex;
+          std::string dir;
+
+          CacheDirectory ()
+          {
+            const char* env = std::getenv ("HPP_PINOCCHIO_CACHE_DIR");
+            if (env != NULL) dir = env;
+          }
+        }; // struct CacheDirectory
+
+        CacheDirectory& cacheDirectoryInstance ()
+        {
+          static CacheDirectory d;
+          return d;
+        }
+      } // namespace
+
+      void cacheDirectory (const std::string& directory)
+      {
+        CacheDirectory& d (cacheDirectoryInstance ());
+        boost::mutex::scoped_lock lock (d.mutex);
+        d.dir = directory;
+      }
+
+      std::string cacheDirectory ()
+      {
+        CacheDirectory& d (cacheDirectoryInstance ());
+        boost::mutex::scoped_lock lock (d.mutex);
+        return d.dir;
+      }
+
+      namespace details {
+        namespace {
+          namespace bip = boost::interprocess;
+          typedef boost::uint64_t uint64;
+          typedef boost::uint32_t uint32;
+
+          /// Layout of a cache entry. All sections are 8 bytes aligned.
+          /// \li Header
+          /// \li for each input of the key, size and digest (2 x uint64),
+          /// \li for each geometry, number of vertices and triangles
+          ///     (2 x uint64), zero for primitives,
+          /// \li collision pairs (2 x uint64 each),
+          /// \li for each mesh, vertices (3 x double each) and triangles
+          ///     (3 x uint32 each), padded to 8 bytes.
+          struct Header {
+            char magic[8];
+            uint32 version;
+            uint32 reserved;
+            uint64 key;
+            uint64 nInputs;
+            uint64 nGeometries;
+            uint64 nPairs;
+          };
+          const char magic[8] = { 'H', 'P', 'P', 'G', 'E', 'O', 'M', 0 };
+          const uint32 version = 2;
+
+          inline std::size_t padding (const std::size_t& n)
+          {
+            return (8 - n % 8) % 8;
+          }
+
+          /// Sequential reader of a memory region
+          struct Reader {
+            const char* data;
+            std::size_t size, pos;
+
+            template <typename T> const T* read (const std::size_t& n)
+            {
+              if (pos + n * sizeof (T) > size) return NULL;
+              const T* res = reinterpret_cast <const T*> (data + pos);
+              pos += n * sizeof (T);
+              return res;
+            }
+          };
+
+          template <typename T> void write (std::ostream& os, const T& t)
+          {
+            os.write (reinterpret_cast <const char*> (&t), sizeof (T));
+          }
+
+          /// Add an input to a key
+          void addInput (CacheKey& key, const char* data,
+                         const std::size_t& size)
+          {
+            // 64 bits FNV-1a
+            uint64 digest = 14695981039346656037ULL;
+            for (std::size_t i = 0; i < size; ++i) {
+              digest ^= (unsigned char) data[i];
+              digest *= 1099511628211ULL;
+            }
+            key.inputs.push_back (CacheKey::Input_t (size, digest));
+            boost::hash_combine (key.hash, size);
+            boost::hash_combine (key.hash, digest);
+          }
+
+          inline void addInput (CacheKey& key, const std::string& s)
+          {
+            addInput (key, s.data (), s.size ());
+          }
+        } // namespace
+
+        std::string readFile (const std::string& filename)
+        {
+          std::ifstream file (filename.c_str (), std::ios::binary);
+          if (!file)
+            throw std::invalid_argument ("Unable to read " + filename);
+          std::ostringstream oss;
+          oss << file.rdbuf ();
+          return oss.str ();
+        }
+
+        CacheKey cacheKey (const std::string& urdf, const std::string& srdf,
+                           const GeometryDescriptions_t& descriptions)
+        {
+          CacheKey key;
+          key.hash = version;
+          addInput (key, urdf);
+          addInput (key, srdf);
+          for (std::size_t i = 0; i < descriptions.size (); ++i) {
+            const GeometryDescription& d = descriptions[i];
+            addInput (key, d.meshPath);
+            if (d.isMesh ()) {
+              double scale[3];
+              for (int k = 0; k < 3; ++k) scale[k] = d.meshScale[k];
+              addInput (key, reinterpret_cast <const char*> (scale),
+                        sizeof (scale));
+              addInput (key, readFile (d.meshPath));
+            }
+          }
+          return key;
+        }
+
+        std::string cacheFileName (const CacheKey& key)
+        {
+          const std::string dir (cacheDirectory ());
+          if (dir.empty ()) return std::string ();
+          std::ostringstream oss;
+          oss << dir;
+          if (*dir.rbegin () != '/') oss << '/';
+          oss << std::hex << std::setw (16) << std::setfill ('0') << key.hash
+            << ".hppgeom";
+          return oss.str ();
+        }
+
+        bool readCache (const std::string& filename, const CacheKey& key,
+                        const GeometryDescriptions_t& descriptions,
+                        CollisionGeometries_t& geometries,
+                        CollisionPairs_t& pairs)
+        {
+          bip::file_mapping file;
+          bip::mapped_region region;
+          try {
+            bip::file_mapping (filename.c_str (), bip::read_only).swap (file);
+            bip::mapped_region (file, bip::read_only).swap (region);
+          } catch (const bip::interprocess_exception&) {
+            hppDout (info, "No model cache entry " << filename);
+            return false;
+          }
+          Reader reader = { static_cast <const char*> (region.get_address ()),
+            region.get_size (), 0 };
+
+          const Header* header = reader.read <Header> (1);
+          if (header == NULL
+              || std::memcmp (header->magic, magic, sizeof (magic)) != 0
+              || header->version != version
+              || header->key != key.hash
+              || header->nInputs != key.inputs.size ()
+              || header->nGeometries != descriptions.size ()) {
+            hppDout (warning, "Invalid model cache entry " << filename);
+            return false;
+          }
+          const uint64* inputs = reader.read <uint64> (2 * header->nInputs);
+          if (inputs == NULL) return false;
+          for (std::size_t k = 0; k < key.inputs.size (); ++k) {
+            if (inputs[2*k] != key.inputs[k].first
+                || inputs[2*k+1] != key.inputs[k].second) {
+              hppDout (warning, "Model cache entry " << filename
+                       << " was written for other inputs");
+              return false;
+            }
+          }
+          const uint64* sizes = reader.read <uint64> (2 * header->nGeometries);
+          const uint64* indices = reader.read <uint64> (2 * header->nPairs);
+          if (sizes == NULL || indices == NULL) return false;
+
+          CollisionGeometries_t result (descriptions.size ());
+          for (std::size_t i = 0; i < descriptions.size (); ++i) {
+            const GeometryDescription& d = descriptions[i];
+            const uint64 nv = sizes[2*i], nt = sizes[2*i+1];
+            if (!d.isMesh ()) {
+              if (nv != 0 || nt != 0) return false;
+              result[i] = loadGeometry (d);
+              continue;
+            }
+            const double* v = reader.read <double> (3 * nv);
+            const uint32* t = reader.read <uint32> (3 * nt);
+            if (v == NULL || t == NULL || nv == 0) return false;
+            reader.pos += padding (3 * nt * sizeof (uint32));
+
+            result[i] = findSharedMesh (d.meshPath, d.meshScale);
+            if (result[i]) continue;
+
+            std::vector <fcl::Vec3f> vertices ((std::size_t)nv);
+            std::vector <fcl::Triangle> triangles ((std::size_t)nt);
+            for (std::size_t k = 0; k < nv; ++k)
+              vertices[k] = fcl::Vec3f (v[3*k], v[3*k+1], v[3*k+2]);
+            for (std::size_t k = 0; k < nt; ++k) {
+              if (t[3*k] >= nv || t[3*k+1] >= nv || t[3*k+2] >= nv)
+                return false;
+              triangles[k] = fcl::Triangle (t[3*k], t[3*k+1], t[3*k+2]);
+            }
+            PolyhedronPtr_t polyhedron (new Polyhedron_t);
+            polyhedron->beginModel ((int)nt, (int)nv);
+            polyhedron->addSubModel (vertices, triangles);
+            polyhedron->endModel ();
+            result[i] = shareMesh (d.meshPath, d.meshScale, polyhedron);
+          }
+
+          pairs.resize ((std::size_t)header->nPairs);
+          for (std::size_t k = 0; k < pairs.size (); ++k) {
+            if (indices[2*k] >= header->nGeometries
+                || indices[2*k+1] >= header->nGeometries)
+              return false;
+            pairs[k] = se3::CollisionPair ((std::size_t)indices[2*k],
+                                           (std::size_t)indices[2*k+1]);
+          }
+          geometries.swap (result);
+          hppDout (info, "Read model cache entry " << filename);
+          return true;
+        }
+
+        void writeCache (const std::string& filename, const CacheKey& key,
+                         const GeometryDescriptions_t& descriptions,
+                         const CollisionGeometries_t& geometries,
+                         const CollisionPairs_t& pairs)
+        {
+          assert (descriptions.size () == geometries.size ());
+          std::vector <const Polyhedron_t*> meshes (descriptions.size (), NULL);
+          for (std::size_t i = 0; i < descriptions.size (); ++i) {
+            if (!descriptions[i].isMesh ()) continue;
+            meshes[i] = dynamic_cast <const Polyhedron_t*> (geometries[i].get ());
+            if (meshes[i] == NULL || meshes[i]->num_vertices == 0) {
+              hppDout (warning, "Cannot cache geometry " << descriptions[i].name);
+              return;
+            }
+          }
+
+          // Write to a temporary file and rename it, so that readers never
+          // see a partial entry. The name of the temporary file is unique so
+          // that concurrent writers of the same entry do not interleave.
+          const std::string pattern (filename + ".XXXXXX");
+          std::vector<char> name (pattern.begin (), pattern.end ());
+          name.push_back ('\0');
+          const int fd = mkstemp (&name[0]);
+          if (fd == -1) {
+            hppDout (warning, "Cannot write model cache entry " << filename);
+            return;
+          }
+          // mkstemp restricts the permissions to the owner.
+          fchmod (fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+          close (fd);
+          const std::string tmp (&name[0]);
+          {
+            std::ofstream os (tmp.c_str (), std::ios::binary);
+            if (!os) {
+              hppDout (warning, "Cannot write model cache entry " << filename);
+              std::remove (tmp.c_str ());
+              return;
+            }
+            Header header;
+            std::memcpy (header.magic, magic, sizeof (magic));
+            header.version = version;
+            header.reserved = 0;
+            header.key = key.hash;
+            header.nInputs = key.inputs.size ();
+            header.nGeometries = descriptions.size ();
+            header.nPairs = pairs.size ();
+            write (os, header);
+
+            for (std::size_t k = 0; k < key.inputs.size (); ++k) {
+              write (os, uint64 (key.inputs[k].first ));
+              write (os, uint64 (key.inputs[k].second));
+            }
+
+            for (std::size_t i = 0; i < meshes.size (); ++i) {
+              write (os, uint64 (meshes[i] ? meshes[i]->num_vertices : 0));
+              write (os, uint64 (meshes[i] ? meshes[i]->num_tris     : 0));
+            }
+            for (std::size_t k = 0; k < pairs.size (); ++k) {
+              write (os, uint64 (pairs[k].first ));
+              write (os, uint64 (pairs[k].second));
+            }
+            for (std::size_t i = 0; i < meshes.size (); ++i) {
+              const Polyhedron_t* m = meshes[i];
+              if (m == NULL) continue;
+              for (int k = 0; k < m->num_vertices; ++k)
+                for (int j = 0; j < 3; ++j)
+                  write (os, double (m->vertices[k][j]));
+              for (int k = 0; k < m->num_tris; ++k)
+                for (int j = 0; j < 3; ++j)
+                  write (os, uint32 (m->tri_indices[k][j]));
+              for (std::size_t p = padding (3 * m->num_tris * sizeof (uint32));
+                   p > 0; --p)
+                os.put (0);
+            }
+            if (!os) {
+              hppDout (warning, "Cannot write model cache entry " << filename);
+              std::remove (tmp.c_str ());
+              return;
+            }
+          }
+          if (std::rename (tmp.c_str (), filename.c_str ()) != 0) {
+            hppDout (warning, "Cannot write model cache entry " << filename);
+            std::remove (tmp.c_str ());
+          }
+        }
+      } // namespace details
+    } // namespace urdf
+  } // namespace pinocchio
+} // namespace hpp
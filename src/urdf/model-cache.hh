@@ -0,0 +1,83 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_PINOCCHIO_SRC_URDF_MODEL_CACHE_HH
+# define HPP_PINOCCHIO_SRC_URDF_MODEL_CACHE_HH
+
+# include <string>
+# include <utility>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+
+# include "geometry.hh"
+
+namespace hpp {
+  namespace pinocchio {
+    namespace urdf {
+      namespace details {
+        /// Read a whole file
+        /// \throw std::invalid_argument if the file cannot be read.
+        std::string readFile (const std::string& filename);
+
+        /// Identity of the inputs of a model in the cache
+        struct CacheKey {
+          typedef std::pair <boost::uint64_t, boost::uint64_t> Input_t;
+          /// Hash of all the inputs, which names the cache entry
+          std::size_t hash;
+          /// Size and 64 bits FNV-1a digest of each input
+          std::vector <Input_t> inputs;
+        };
+
+        /// Compute the key of a model in the cache
+        ///
+        /// The inputs are the URDF and SRDF descriptions, the mesh paths
+        /// and scales and the content of the mesh files, so that a modified
+        /// file invalidates the cache entry. The size and digest of each
+        /// input are stored in the entry and compared when it is read, so
+        /// that a collision of the hash naming the entry is detected.
+        CacheKey cacheKey (const std::string& urdf, const std::string& srdf,
+                           const GeometryDescriptions_t& descriptions);
+
+        /// Path of the cache entry of a key
+        /// \return an empty string if the cache is disabled.
+        std::string cacheFileName (const CacheKey& key);
+
+        /// Read a cache entry
+        ///
+        /// The file is memory mapped. Meshes are built from the stored
+        /// vertices and triangles, primitives are created from the
+        /// descriptions.
+        /// \return false if the file does not exist, is not a valid entry
+        ///         for key or does not match the descriptions.
+        bool readCache (const std::string& filename, const CacheKey& key,
+                        const GeometryDescriptions_t& descriptions,
+                        CollisionGeometries_t& geometries,
+                        CollisionPairs_t& pairs);
+
+        /// Write a cache entry
+        ///
+        /// Errors are reported in the log and otherwise ignored.
+        void writeCache (const std::string& filename, const CacheKey& key,
+                         const GeometryDescriptions_t& descriptions,
+                         const CollisionGeometries_t& geometries,
+                         const CollisionPairs_t& pairs);
+      } // namespace details
+    } // namespace urdf
+  } // namespace pinocchio
+} // namespace hpp
+
+#endif // HPP_PINOCCHIO_SRC_URDF_MODEL_CACHE_HH
@@ -22,7 +22,6 @@
 #include <pinocchio/parsers/urdf.hpp>
 #include <pinocchio/multibody/geometry.hpp>
 #include <pinocchio/algorithm/geometry.hpp>
-#include <pinocchio/parsers/srdf.hpp>
 
 #include <hpp/util/debug.hh>
 
@@ -30,6 +29,9 @@
 #include <hpp/pinocchio/device.hh>
 #include <hpp/pinocchio/humanoid-robot.hh>
 
+#include "geometry.hh"
+#include "model-cache.hh"
+
 namespace hpp {
   namespace pinocchio {
     namespace urdf {
@@ -114,7 +116,7 @@ namespace hpp {
         }
 
         void setPrefix (const std::string& prefix,
-            Model& model, GeomModel& geomModel,
+            Model& model,
             const JointIndex& idFirstJoint,
             const FrameIndex& idFirstFrame)
         {
@@ -125,6 +127,10 @@ namespace hpp {
             se3::Frame& f = model.frames[i];
             f.name = prefix + f.name;
           }
+        }
+
+        void setPrefix (const std::string& prefix, GeomModel& geomModel)
+        {
           BOOST_FOREACH(se3::GeometryObject& go, geomModel.geometryObjects) {
             go.name = prefix + go.name;
           }
@@ -166,28 +172,76 @@ namespace hpp {
           return ss.str();
         }
 
-        template <bool XmlString>
-        void _removeCollisionPairs (
-            const Model& model,
-            GeomModel& geomModel,
-            const std::string& srdf,
-            bool verbose)
+        GeometryLoading_t& geometryLoadingRef ()
         {
-          se3::srdf::removeCollisionPairsFromSrdfString
-            (model, geomModel, srdf, verbose);
+          static GeometryLoading_t mode = LOAD_GEOMETRY_NOW;
+          return mode;
         }
 
-        template <>
-        void _removeCollisionPairs<false> (
-            const Model& model,
-            GeomModel& geomModel,
-            const std::string& srdf,
-            bool verbose)
+        std::size_t& geometryLoadingThreadsRef ()
         {
-          se3::srdf::removeCollisionPairsFromSrdf
-            (model, geomModel, srdf, verbose);
+          static std::size_t n = 0;
+          return n;
         }
 
+        /// Load the geometries of a URDF model
+        ///
+        /// It works on a copy of the kinematic model, before the prefix is
+        /// added to the names, so that it does not access the device and
+        /// can be called later or in a separate thread.
+        template <bool srdfAsXmlString>
+        struct GeometryLoader
+        {
+          boost::shared_ptr<const Model> model;
+          ::urdf::ModelInterfaceSharedPtr urdfTree;
+          std::string urdf;
+          std::string srdf;
+          std::string prefix;
+
+          void operator() (GeomModel& geomModel) const
+          {
+            std::vector<std::string> baseDirs = se3::rosPaths();
+            details::GeometryDescriptions_t descriptions;
+            details::parseGeometries (urdfTree, *model, baseDirs, descriptions);
+
+            const std::string srdfString
+              (srdfAsXmlString || srdf.empty() ? srdf : details::readFile (srdf));
+
+            // Look for the meshes and collision pairs in the cache.
+            details::CollisionGeometries_t geometries;
+            details::CollisionPairs_t pairs;
+            details::CacheKey key;
+            std::string cacheFile;
+            bool cached = false;
+            if (!cacheDirectory().empty()) {
+              key = details::cacheKey (urdf, srdfString, descriptions);
+              cacheFile = details::cacheFileName (key);
+              cached = details::readCache (cacheFile, key, descriptions,
+                                           geometries, pairs);
+            }
+
+            if (!cached)
+              details::loadGeometries (descriptions, geometries,
+                                       geometryLoadingThreads ());
+            details::addGeometries (*model, descriptions, geometries, geomModel);
+
+            if (!cached) {
+              details::FramePairs_t disabled;
+              if (!srdfString.empty())
+                details::parseDisabledCollisions (srdfString, *model, disabled);
+              details::buildCollisionPairs (descriptions, disabled, pairs);
+              if (!cacheFile.empty())
+                details::writeCache (cacheFile, key, descriptions, geometries,
+                                     pairs);
+            }
+            geomModel.collisionPairs = pairs;
+
+            if (!prefix.empty()) setPrefix(prefix, geomModel);
+
+            hppDout (notice, "Finished loading geometries.");
+          }
+        };
+
         template <bool srdfAsXmlString>
         void _loadModel (const DevicePtr_t& robot,
                         const JointIndex&  baseJoint,
@@ -211,35 +265,53 @@ namespace hpp {
 
           hppDout (notice, "Finished parsing URDF file.");
 
-          GeomModel geomModel;
+          if (!prefix.empty() && *prefix.rbegin() != '/') prefix += "/";
 
-          std::vector<std::string> baseDirs = se3::rosPaths();
-          se3::urdf::buildGeom(model, urdfStream, se3::COLLISION, geomModel, baseDirs);
-          geomModel.addAllCollisionPairs();
+          GeometryLoader<srdfAsXmlString> loader;
+          loader.model.reset (new Model (model));
+          loader.urdfTree = urdfTree;
+          std::ostringstream urdfString;
+          urdfString << urdfStream.rdbuf();
+          loader.urdf = urdfString.str();
+          loader.srdf = srdf;
+          loader.prefix = prefix;
 
-          if (!srdf.empty()) {
-            _removeCollisionPairs<srdfAsXmlString>
-              (model, geomModel, srdf, verbose);
-          }
-
-          if (!prefix.empty()) {
-            if (*prefix.rbegin() != '/') prefix += "/";
-            setPrefix(prefix, model, geomModel, idFirstJoint, idFirstFrame);
-          }
+          if (!prefix.empty())
+            setPrefix(prefix, model, idFirstJoint, idFirstFrame);
 
           // Update root joint bounds
           assert((rootType == "anchor")
               || (model.names[idFirstJoint] == prefix + "root_joint"));
           setRootJointBounds(model, idFirstJoint, rootType);
 
-          se3::appendGeometryModel(robot->geomModel(), geomModel);
-          robot->createGeomData();
-
-          hppDout (notice, "Finished parsing SRDF file.");
+          const GeometryLoading_t mode = geometryLoading();
+          robot->deferGeometry (loader, mode == LOAD_GEOMETRY_IN_BACKGROUND);
+          if (mode == LOAD_GEOMETRY_NOW)
+            robot->loadDeferredGeometry();
         }
 
       }
 
+      void geometryLoading (GeometryLoading_t mode)
+      {
+        geometryLoadingRef () = mode;
+      }
+
+      GeometryLoading_t geometryLoading ()
+      {
+        return geometryLoadingRef ();
+      }
+
+      void geometryLoadingThreads (std::size_t n)
+      {
+        geometryLoadingThreadsRef () = n;
+      }
+
+      std::size_t geometryLoadingThreads ()
+      {
+        return geometryLoadingThreadsRef ();
+      }
+
       void loadRobotModel (const DevicePtr_t& robot,
 			   const std::string& rootJointType,
 			   const std::string& package,
@@ -0,0 +1,65 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE tconfiguration_metric
+
+#include <boost/test/unit_test.hpp>
+
+#include <pinocchio/algorithm/joint-configuration.hpp>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/configuration-metric.hh>
+#include <hpp/pinocchio/simple-device.hh>
+
+using namespace hpp::pinocchio;
+
+BOOST_AUTO_TEST_CASE (unit_weights)
+{
+  DevicePtr_t robot = humanoidSimple ("humanoid", true);
+  robot->model().lowerPositionLimit.head<3>().setConstant(-1);
+  robot->model().upperPositionLimit.head<3>().setConstant( 1);
+  ConfigurationMetricPtr_t metric = ConfigurationMetric::create (robot);
+
+  for (int i = 0; i < 100; ++i) {
+    Configuration_t q1 = se3::randomConfiguration (robot->model()),
+                    q2 = se3::randomConfiguration (robot->model());
+    BOOST_CHECK_CLOSE (metric->distance (q1, q2), distance (robot, q1, q2),
+                       1e-6);
+    BOOST_CHECK_SMALL (metric->distance (q1, q1), 1e-10);
+  }
+
+  // Scaling all the weights scales the distance.
+  metric->weights (2 * metric->weights ());
+  Configuration_t q1 = se3::randomConfiguration (robot->model()),
+                  q2 = se3::randomConfiguration (robot->model());
+  BOOST_CHECK_CLOSE (metric->distance (q1, q2), 2 * distance (robot, q1, q2),
+                     1e-6);
+}
+
+BOOST_AUTO_TEST_CASE (computed_weights)
+{
+  DevicePtr_t robot = humanoidSimple ("humanoid", true);
+  ConfigurationMetricPtr_t metric = ConfigurationMetric::create (robot);
+
+  metric->computeWeights (false, 1e-2);
+  BOOST_CHECK_EQUAL (metric->weights ().size (),
+                     robot->getJointVector ().size ());
+  BOOST_CHECK (metric->weights ().minCoeff () >= 1e-2);
+
+  metric->computeWeights (true, 1e-3);
+  BOOST_CHECK (metric->weights ().minCoeff () >= 1e-3);
+}
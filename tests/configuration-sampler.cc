@@ -0,0 +1,72 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE tconfiguration_sampler
+
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/configuration-sampler.hh>
+#include <hpp/pinocchio/simple-device.hh>
+
+using namespace hpp::pinocchio;
+
+BOOST_AUTO_TEST_CASE (sample)
+{
+  DevicePtr_t robot = humanoidSimple ("humanoid", true);
+  robot->setDimensionExtraConfigSpace (2);
+  for (size_type k = 0; k < 2; ++k) {
+    robot->extraConfigSpace ().lower (k) = -2;
+    robot->extraConfigSpace ().upper (k) =  3;
+  }
+
+  // Unbounded translations cannot be sampled.
+  robot->model().lowerPositionLimit.head<3>().setConstant(
+      -std::numeric_limits<value_type>::infinity());
+  ConfigurationSamplerPtr_t sampler = ConfigurationSampler::create (robot, 1, 2);
+  matrix_t qs (robot->configSize (), 100);
+  BOOST_CHECK_THROW (sampler->sampleMany (qs), std::invalid_argument);
+
+  robot->model().lowerPositionLimit.head<3>().setConstant(-1);
+  robot->model().upperPositionLimit.head<3>().setConstant( 1);
+  sampler->sampleMany (qs);
+
+  const size_type nq = robot->model().nq;
+  for (size_type j = 0; j < qs.cols (); ++j) {
+    BOOST_CHECK (isNormalized (robot, qs.col (j), 1e-10));
+    BOOST_CHECK ((qs.col (j).head (nq).array ()
+          <= robot->model().upperPositionLimit.array ()).all ());
+    BOOST_CHECK ((qs.col (j).head (nq).array ()
+          >= robot->model().lowerPositionLimit.array ()).all ());
+    BOOST_CHECK ((qs.col (j).tail<2> ().array () <=  3).all ());
+    BOOST_CHECK ((qs.col (j).tail<2> ().array () >= -2).all ());
+  }
+
+  // Streams are reproducible and independent.
+  matrix_t qs1 (robot->configSize (), 10), qs2 (robot->configSize (), 10);
+  sampler->seed (3);
+  sampler->sampleMany (qs1, 1);
+  sampler->seed (3);
+  sampler->sampleMany (qs2, 0);
+  BOOST_CHECK (!qs1.isApprox (qs2));
+  sampler->sampleMany (qs2, 1);
+  BOOST_CHECK (qs1.isApprox (qs2));
+
+  Configuration_t q (robot->configSize ());
+  sampler->sample (q);
+  BOOST_CHECK (isNormalized (robot, q, 1e-10));
+}
@@ -18,16 +18,39 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sstream>
+
 #include <hpp/pinocchio/joint.hh>
 #include <hpp/pinocchio/device.hh>
 #include <hpp/pinocchio/simple-device.hh>
 #include <hpp/pinocchio/humanoid-robot.hh>
 #include <hpp/pinocchio/urdf/util.hh>
 #include <hpp/pinocchio/liegroup-space.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/center-of-mass-computation.hh>
+#include <hpp/pinocchio/multi-center-of-mass-computation.hh>
+#include <hpp/pinocchio/sphere-approximation.hh>
+#include <hpp/pinocchio/distance-field.hh>
+
+#include <hpp/fcl/BV/OBBRSS.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+
+#include <pinocchio/multibody/geometry.hpp>
+#include <pinocchio/parsers/srdf.hpp>
+#include <pinocchio/parsers/utils.hpp>
+
+#include "../src/urdf/geometry.hh"
 
 static bool verbose = true;
 
 using namespace hpp::pinocchio;
+// Both ::urdf and hpp::pinocchio::urdf are visible.
+namespace urdfDetails = hpp::pinocchio::urdf::details;
 
 DevicePtr_t makeDeviceSafe (unittest::TestDeviceType type) {
   try {
@@ -39,6 +62,19 @@ DevicePtr_t makeDeviceSafe (unittest::TestDeviceType type) {
   }
 }
 
+std::vector<std::string> listDirectory (const std::string& dir)
+{
+  std::vector<std::string> names;
+  DIR* d = opendir (dir.c_str());
+  if (d == NULL) return names;
+  for (struct dirent* e = readdir(d); e != NULL; e = readdir(d)) {
+    const std::string name (e->d_name);
+    if (name != "." && name != "..") names.push_back (name);
+  }
+  closedir (d);
+  return names;
+}
+
 void displayAABB(const fcl::AABB& aabb)
 {
     std::cout << "Bounding box is\n"
@@ -87,3 +123,522 @@ BOOST_AUTO_TEST_CASE (unit_test_device)
   space->mergeVectorSpaces();
   BOOST_CHECK_EQUAL (space->name(), "R^19");
 }
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (centerOfMassComputation)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+
+  Configuration_t q (robot->configSize());
+  vector_t v (vector_t::Random(robot->numberDof()));
+  integrate (robot, robot->neutralConfiguration(), v, q);
+  robot->currentConfiguration(q);
+  robot->computeForwardKinematics();
+
+  // Whole robot
+  CenterOfMassComputationPtr_t com = CenterOfMassComputation::create(robot);
+  com->add(robot->rootJoint());
+  com->compute(Device::ALL);
+  BOOST_CHECK_CLOSE(com->mass(), robot->mass(), 1e-8);
+  BOOST_CHECK(com->com().isApprox(robot->positionCenterOfMass()));
+  BOOST_CHECK(com->jacobian().isApprox(robot->jacobianCenterOfMass()));
+
+  // Subtrees: only the subtree joints and their ancestors are visited.
+  const Model& model = robot->model();
+  const Data& data = robot->data();
+  JointPtr_t j0 = robot->rootJoint()->childJoint(0);
+  JointPtr_t j1 = robot->rootJoint()->childJoint(1);
+  com = CenterOfMassComputation::create(robot);
+  com->add(j0);
+  com->add(j1);
+  com->compute(Device::ALL);
+
+  value_type mass = 0;
+  vector3_t c (vector3_t::Zero());
+  std::size_t n = 1;
+  for (JointIndex i = j0->index(); i <= JointIndex(data.lastChild[j0->index()]); ++i, ++n) {
+    mass += model.inertias[i].mass();
+    c += model.inertias[i].mass() * data.oMi[i].act(model.inertias[i].lever());
+  }
+  for (JointIndex i = j1->index(); i <= JointIndex(data.lastChild[j1->index()]); ++i, ++n) {
+    mass += model.inertias[i].mass();
+    c += model.inertias[i].mass() * data.oMi[i].act(model.inertias[i].lever());
+  }
+  BOOST_CHECK_EQUAL(com->joints().size(), n);
+  BOOST_CHECK_CLOSE(com->mass(), mass, 1e-8);
+  BOOST_CHECK(com->com().isApprox(c / mass));
+
+  // Incremental update: move the last joint, then the first joint of j1.
+  com = CenterOfMassComputation::create(robot);
+  com->add(robot->rootJoint());
+  com->compute(Device::ALL);
+  for (std::size_t k = 0; k < 2; ++k) {
+    JointPtr_t moved = (k == 0
+        ? JointPtr_t(new Joint(robot, model.joints.size() - 1)) : j1);
+    vector_t dv (vector_t::Zero(robot->numberDof()));
+    dv.segment(moved->rankInVelocity(), moved->numberDof()).setRandom();
+    integrate (robot, Configuration_t(q), dv, q);
+    robot->currentConfiguration(q);
+    robot->computeForwardKinematics();
+
+    com->compute(Device::ALL);
+    BOOST_CHECK(com->com().isApprox(robot->positionCenterOfMass()));
+    BOOST_CHECK(com->jacobian().isApprox(robot->jacobianCenterOfMass()));
+  }
+
+  // Same configuration, but a joint placement and then a mass change.
+  Model& m = robot->model();
+  const JointIndex moved = j1->index();
+  const Transform3f placement (m.jointPlacements[moved]);
+  const se3::Inertia inertia (m.inertias[moved]);
+  for (std::size_t k = 0; k < 2; ++k) {
+    if (k == 0)
+      m.jointPlacements[moved].translation() += vector3_t(0.1, 0, 0);
+    else
+      m.inertias[moved] = se3::Inertia (2 * inertia.mass(), inertia.lever(),
+                                        inertia.inertia());
+    robot->computeForwardKinematics();
+
+    com->compute(Device::ALL);
+    BOOST_CHECK_CLOSE(com->mass(), robot->mass(), 1e-8);
+    BOOST_CHECK(com->com().isApprox(robot->positionCenterOfMass()));
+    BOOST_CHECK(com->jacobian().isApprox(robot->jacobianCenterOfMass()));
+  }
+  m.jointPlacements[moved] = placement;
+  m.inertias[moved] = inertia;
+  robot->computeForwardKinematics();
+
+  // Compact Jacobian of a subtree
+  com = CenterOfMassComputation::create(robot);
+  com->add(j0);
+  com->compute(Device::ALL);
+  const CompactJacobian& Jc = com->compactJacobian();
+  BOOST_CHECK_EQUAL(Jc.cols(), robot->numberDof());
+  BOOST_CHECK(Jc.matrix().cols() < robot->numberDof());
+  BOOST_CHECK(Jc.dense().isApprox(com->jacobian()));
+
+  vector_t w (vector_t::Random(3)), Jv (3), Jtw (robot->numberDof());
+  Jc.multiply(v, Jv);
+  BOOST_CHECK(Jv.isApprox(com->jacobian() * v));
+  Jc.transposeMultiply(w, Jtw);
+  BOOST_CHECK(Jtw.isApprox(com->jacobian().transpose() * w));
+  matrix_t A (matrix_t::Random(robot->numberDof(), 4)), JA (3, 4);
+  Jc.multiplyMatrix(A, JA);
+  BOOST_CHECK(JA.isApprox(com->jacobian() * A));
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (multiCenterOfMassComputation)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+
+  Configuration_t q (robot->configSize());
+  vector_t v (vector_t::Random(robot->numberDof()));
+  integrate (robot, robot->neutralConfiguration(), v, q);
+  robot->currentConfiguration(q);
+  robot->computeForwardKinematics();
+
+  JointPtr_t j0 = robot->rootJoint()->childJoint(0);
+  JointPtr_t j1 = robot->rootJoint()->childJoint(1);
+
+  std::vector<CenterOfMassComputationPtr_t> coms (3);
+  for (std::size_t i = 0; i < coms.size(); ++i)
+    coms[i] = CenterOfMassComputation::create(robot);
+  coms[0]->add(robot->rootJoint());
+  coms[1]->add(j0);
+  coms[2]->add(j0);
+  coms[2]->add(j1);
+
+  MultiCenterOfMassComputationPtr_t multi =
+    MultiCenterOfMassComputation::create(robot);
+  for (std::size_t i = 0; i < coms.size(); ++i) {
+    std::size_t g = multi->addGroup();
+    BOOST_CHECK_EQUAL(g, i);
+    for (std::size_t k = 0; k < coms[i]->roots().size(); ++k)
+      multi->add(g, JointPtr_t(new Joint(robot, coms[i]->roots()[k])));
+  }
+  BOOST_CHECK_THROW(multi->add(2, j1), std::invalid_argument);
+
+  multi->compute(Device::ALL);
+  for (std::size_t i = 0; i < coms.size(); ++i) {
+    coms[i]->compute(Device::ALL);
+    BOOST_CHECK_CLOSE(multi->mass(i), coms[i]->mass(), 1e-8);
+    BOOST_CHECK(multi->com(i).isApprox(coms[i]->com()));
+
+    BOOST_CHECK(multi->jacobian(i).dense().isApprox(coms[i]->jacobian()));
+  }
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (modelCache)
+{
+  const std::string dir = hpp::pinocchio::urdf::cacheDirectory();
+  char cacheDir[] = "/tmp/hpp-pinocchio-cache-XXXXXX";
+  BOOST_REQUIRE(mkdtemp (cacheDir) != NULL);
+  hpp::pinocchio::urdf::cacheDirectory (cacheDir);
+
+  // The first load fills the cache.
+  DevicePtr_t robot0 = makeDeviceSafe(unittest::HumanoidRomeo);
+  // No temporary file is left in the directory.
+  std::vector<std::string> entries (listDirectory (cacheDir));
+  BOOST_CHECK_EQUAL(entries.size(), 1u);
+  if (!entries.empty())
+    BOOST_CHECK(entries[0].find (".hppgeom") == entries[0].size() - 8);
+  const std::string entry (std::string (cacheDir) + "/"
+      + (entries.empty() ? std::string() : entries[0]));
+  struct stat s0, s1;
+  BOOST_CHECK(stat (entry.c_str(), &s0) == 0);
+
+  // The second load reads it. A miss would parse the meshes and the SRDF
+  // again and replace the entry by a new file.
+  DevicePtr_t robot1 = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_CHECK(stat (entry.c_str(), &s1) == 0);
+  BOOST_CHECK_EQUAL(s0.st_ino, s1.st_ino);
+  BOOST_CHECK_EQUAL(listDirectory (cacheDir).size(), 1u);
+
+  hpp::pinocchio::urdf::cacheDirectory (dir);
+  entries = listDirectory (cacheDir);
+  for (std::size_t i = 0; i < entries.size(); ++i)
+    unlink ((std::string (cacheDir) + "/" + entries[i]).c_str());
+  rmdir (cacheDir);
+  BOOST_REQUIRE(robot0 && robot1);
+
+  const GeomModel& g0 = robot0->geomModel();
+  const GeomModel& g1 = robot1->geomModel();
+  BOOST_REQUIRE_EQUAL(g0.geometryObjects.size(), g1.geometryObjects.size());
+  for (std::size_t i = 0; i < g0.geometryObjects.size(); ++i) {
+    BOOST_CHECK_EQUAL(g0.geometryObjects[i].name, g1.geometryObjects[i].name);
+    BOOST_CHECK(g0.geometryObjects[i].placement.isApprox(
+          g1.geometryObjects[i].placement));
+    BOOST_CHECK_EQUAL(g0.geometryObjects[i].fcl->getNodeType(),
+                      g1.geometryObjects[i].fcl->getNodeType());
+  }
+  BOOST_REQUIRE_EQUAL(g0.collisionPairs.size(), g1.collisionPairs.size());
+  for (std::size_t i = 0; i < g0.collisionPairs.size(); ++i)
+    BOOST_CHECK(g0.collisionPairs[i] == g1.collisionPairs[i]);
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (sharedMeshes)
+{
+  DevicePtr_t robot0 = makeDeviceSafe(unittest::HumanoidRomeo);
+  DevicePtr_t robot1 = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot0 && robot1);
+
+  const GeomModel& g0 = robot0->geomModel();
+  const GeomModel& g1 = robot1->geomModel();
+  BOOST_REQUIRE_EQUAL(g0.geometryObjects.size(), g1.geometryObjects.size());
+  for (std::size_t i = 0; i < g0.geometryObjects.size(); ++i) {
+    if (g0.geometryObjects[i].fcl->getObjectType() != fcl::OT_BVH) continue;
+    BOOST_CHECK_EQUAL(g0.geometryObjects[i].fcl.get(),
+                      g1.geometryObjects[i].fcl.get());
+  }
+}
+/* -------------------------------------------------------------------------- */
+urdfDetails::GeometryDescription boxDescription (const double& size)
+{
+  ::urdf::Box* box = new ::urdf::Box;
+  box->dim = ::urdf::Vector3 (size, size, size);
+  urdfDetails::GeometryDescription d;
+  d.name = "box";
+  d.frame = 0;
+  d.joint = 0;
+  d.placement.setIdentity();
+  d.geometry = ::urdf::GeometrySharedPtr (box);
+  d.meshPath = "BOX";
+  d.meshScale.setOnes();
+  return d;
+}
+
+urdfDetails::GeometryDescription meshDescription (const std::string& path,
+                                                 const vector3_t& scale)
+{
+  ::urdf::Mesh* mesh = new ::urdf::Mesh;
+  mesh->filename = path;
+  mesh->scale = ::urdf::Vector3 (scale[0], scale[1], scale[2]);
+  urdfDetails::GeometryDescription d;
+  d.name = "mesh";
+  d.frame = 0;
+  d.joint = 0;
+  d.placement.setIdentity();
+  d.geometry = ::urdf::GeometrySharedPtr (mesh);
+  d.meshPath = path;
+  d.meshScale = scale;
+  return d;
+}
+
+BOOST_AUTO_TEST_CASE (loadGeometries)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+  std::string meshPath;
+  const GeomModel& g = robot->geomModel();
+  for (std::size_t i = 0; i < g.geometryObjects.size(); ++i) {
+    if (g.geometryObjects[i].fcl->getObjectType() != fcl::OT_BVH) continue;
+    meshPath = g.geometryObjects[i].meshPath;
+    break;
+  }
+  BOOST_REQUIRE(!meshPath.empty());
+  // A scale that no other test uses, so that the mesh is loaded here.
+  const vector3_t scale (vector3_t::Constant (0.123));
+
+  // Results are stored in the order of the descriptions and elements with
+  // the same mesh share it.
+  urdfDetails::GeometryDescriptions_t descriptions;
+  for (std::size_t i = 0; i < 8; ++i) {
+    if (i % 3 == 1) descriptions.push_back (meshDescription (meshPath, scale));
+    else descriptions.push_back (boxDescription ((double) i + 1));
+  }
+  urdfDetails::CollisionGeometries_t geometries;
+  urdfDetails::loadGeometries (descriptions, geometries, 4);
+  BOOST_REQUIRE_EQUAL(geometries.size(), descriptions.size());
+  for (std::size_t i = 0; i < geometries.size(); ++i) {
+    BOOST_REQUIRE(geometries[i]);
+    if (i % 3 == 1) {
+      BOOST_CHECK_EQUAL(geometries[i]->getObjectType(), fcl::OT_BVH);
+      BOOST_CHECK_EQUAL(geometries[i].get(), geometries[1].get());
+    } else {
+      const fcl::Box* box =
+        dynamic_cast <const fcl::Box*> (geometries[i].get());
+      BOOST_REQUIRE(box);
+      BOOST_CHECK_EQUAL(box->side[0], (double) i + 1);
+    }
+  }
+
+  // The error of the first description that fails is rethrown, whatever
+  // the order in which the threads fail.
+  descriptions.clear();
+  for (std::size_t i = 0; i < 8; ++i) {
+    std::ostringstream path;
+    path << "/nonexistent/mesh-" << i << ".dae";
+    if (i == 2 || i == 5)
+      descriptions.push_back (meshDescription (path.str(), scale));
+    else descriptions.push_back (boxDescription ((double) i + 1));
+  }
+  for (std::size_t k = 0; k < 10; ++k) {
+    try {
+      urdfDetails::loadGeometries (descriptions, geometries, 4);
+      BOOST_ERROR("Loading a missing mesh should throw.");
+    } catch (const std::exception& e) {
+      const std::string what (e.what());
+      BOOST_CHECK(what.find ("mesh-2.dae") != std::string::npos);
+      BOOST_CHECK(what.find ("mesh-5.dae") == std::string::npos);
+    }
+  }
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (deferredGeometry)
+{
+  DevicePtr_t robot0 = makeDeviceSafe(unittest::HumanoidRomeo);
+  hpp::pinocchio::urdf::geometryLoading
+    (hpp::pinocchio::urdf::LOAD_GEOMETRY_ON_DEMAND);
+  DevicePtr_t robot1 = makeDeviceSafe(unittest::HumanoidRomeo);
+  hpp::pinocchio::urdf::geometryLoading
+    (hpp::pinocchio::urdf::LOAD_GEOMETRY_IN_BACKGROUND);
+  DevicePtr_t robot2 = makeDeviceSafe(unittest::HumanoidRomeo);
+  hpp::pinocchio::urdf::geometryLoading
+    (hpp::pinocchio::urdf::LOAD_GEOMETRY_NOW);
+  BOOST_REQUIRE(robot0 && robot1 && robot2);
+
+  BOOST_CHECK(!robot0->hasDeferredGeometry());
+  BOOST_CHECK(robot1->hasDeferredGeometry());
+  BOOST_CHECK(robot2->hasDeferredGeometry());
+
+  // The kinematic model is usable without the geometries.
+  robot1->currentConfiguration (robot1->neutralConfiguration());
+  robot1->computeForwardKinematics ();
+  BOOST_CHECK(robot1->hasDeferredGeometry());
+
+  const GeomModel& g0 = robot0->geomModel();
+  DevicePtr_t robots[2] = { robot1, robot2 };
+  for (std::size_t r = 0; r < 2; ++r) {
+    const GeomModel& g = robots[r]->geomModel();
+    BOOST_CHECK(!robots[r]->hasDeferredGeometry());
+    BOOST_REQUIRE_EQUAL(g0.geometryObjects.size(), g.geometryObjects.size());
+    for (std::size_t i = 0; i < g0.geometryObjects.size(); ++i)
+      BOOST_CHECK_EQUAL(g0.geometryObjects[i].name, g.geometryObjects[i].name);
+    BOOST_CHECK_EQUAL(g0.collisionPairs.size(), g.collisionPairs.size());
+    BOOST_CHECK_EQUAL(robot0->geomData().radius.size(),
+                      robots[r]->geomData().radius.size());
+  }
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (collisionPairs)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+
+  // Compare with all pairs minus the pairs disabled in the SRDF.
+  const std::string srdf = se3::retrieveResourcePath
+    ("package://romeo_description/srdf/romeo_small.srdf", se3::rosPaths());
+  BOOST_REQUIRE(!srdf.empty());
+  GeomModel geomModel (robot->geomModel());
+  geomModel.addAllCollisionPairs();
+  se3::srdf::removeCollisionPairsFromSrdf
+    (robot->model(), geomModel, srdf, false);
+
+  const GeomModel& g = robot->geomModel();
+  BOOST_REQUIRE_EQUAL(geomModel.collisionPairs.size(), g.collisionPairs.size());
+  for (std::size_t i = 0; i < g.collisionPairs.size(); ++i)
+    BOOST_CHECK(geomModel.collisionPairs[i] == g.collisionPairs[i]);
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (collisionProxies)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+  const GeomModel& geomModel = robot->geomModel();
+  const GeomData& geomData = robot->geomData();
+
+  Configuration_t q (robot->configSize());
+  for (int i = 0; i < 20; ++i) {
+    vector_t v (vector_t::Random(robot->numberDof()));
+    integrate (robot, robot->neutralConfiguration(), v, q);
+    robot->currentConfiguration(q);
+    robot->computeForwardKinematics();
+
+    robot->useCollisionProxies (false);
+    const bool collision = robot->collisionTest (false);
+    std::vector<bool> collisions (geomModel.collisionPairs.size());
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      collisions[k] = geomData.collisionResults[k].isCollision();
+
+    robot->useCollisionProxies (true);
+    BOOST_CHECK_EQUAL(collision, robot->collisionTest (false));
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      BOOST_CHECK_EQUAL(collisions[k],
+                        geomData.collisionResults[k].isCollision());
+
+    robot->computeDistances();
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      BOOST_CHECK(robot->distanceLowerBound (k)
+                  <= robot->distanceResults()[k].min_distance + 1e-6);
+  }
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (sphereApproximation)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+  const GeomModel& geomModel = robot->geomModel();
+  const GeomData& geomData = robot->geomData();
+  SphereApproximationPtr_t spheres = SphereApproximation::create (robot);
+  BOOST_CHECK(spheres->size() >= (size_type)geomModel.geometryObjects.size());
+
+  Configuration_t q (robot->configSize());
+  for (int i = 0; i < 20; ++i) {
+    vector_t v (vector_t::Random(robot->numberDof()));
+    integrate (robot, robot->neutralConfiguration(), v, q);
+    robot->currentConfiguration(q);
+    robot->computeForwardKinematics();
+
+    const bool collision = robot->collisionTest (false);
+    std::vector<bool> collisions (geomModel.collisionPairs.size());
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      collisions[k] = geomData.collisionResults[k].isCollision();
+
+    spheres->compute();
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      if (collisions[k]) BOOST_CHECK(spheres->overlap (k));
+    BOOST_CHECK_EQUAL(collision, spheres->collisionTest (false));
+    for (std::size_t k = 0; k < collisions.size(); ++k)
+      BOOST_CHECK_EQUAL(collisions[k],
+                        geomData.collisionResults[k].isCollision());
+  }
+
+  // Add a geometry after the spheres were built.
+  const se3::JointIndex joint = robot->model().joints.size() - 1;
+  const se3::GeomIndex added = robot->geomModel().addGeometryObject
+    (se3::GeometryObject ("added", 0, joint,
+      boost::shared_ptr<fcl::CollisionGeometry> (new fcl::Sphere (.1)),
+      Transform3f::Identity()), robot->model());
+  const std::size_t pairIndex = geomModel.collisionPairs.size();
+  robot->geomModel().addCollisionPair (se3::CollisionPair (0, added));
+  robot->createGeomData();
+
+  // Not approximated yet: fall back to the exact test.
+  BOOST_CHECK(spheres->overlap (pairIndex));
+  spheres->compute();
+  BOOST_CHECK(spheres->size() >= (size_type)geomModel.geometryObjects.size());
+  const bool collision = robot->collisionTest (false);
+  BOOST_CHECK_EQUAL(collision, spheres->collisionTest (false));
+  if (robot->geomData().collisionResults[pairIndex].isCollision())
+    BOOST_CHECK(spheres->overlap (pairIndex));
+}
+/* -------------------------------------------------------------------------- */
+BOOST_AUTO_TEST_CASE (distanceField)
+{
+  DevicePtr_t robot = makeDeviceSafe(unittest::HumanoidRomeo);
+  BOOST_REQUIRE(robot);
+
+  // A spherical obstacle
+  const value_type radius = .2;
+  const vector3_t center (2, 0, 0);
+  robot->geomModel().addGeometryObject (se3::GeometryObject ("obstacle", 0, 0,
+        boost::shared_ptr<fcl::CollisionGeometry> (new fcl::Sphere (radius)),
+        Transform3f (matrix3_t::Identity(), center)), robot->model());
+  // A closed mesh: a cube
+  const value_type half = .15;
+  const vector3_t cubeCenter (2, .8, 0);
+  std::vector<fcl::Vec3f> vertices;
+  std::vector<fcl::Triangle> triangles;
+  for (int k = 0; k < 8; ++k)
+    vertices.push_back (fcl::Vec3f ((k & 1 ? half : -half),
+          (k & 2 ? half : -half), (k & 4 ? half : -half)));
+  const int faces[12][3] = { {0,2,6}, {0,6,4}, {1,5,7}, {1,7,3},
+    {0,4,5}, {0,5,1}, {2,3,7}, {2,7,6}, {0,1,3}, {0,3,2}, {4,6,7}, {4,7,5} };
+  for (int k = 0; k < 12; ++k)
+    triangles.push_back (fcl::Triangle (faces[k][0], faces[k][1], faces[k][2]));
+  boost::shared_ptr<fcl::BVHModel<fcl::OBBRSS> > cube
+    (new fcl::BVHModel<fcl::OBBRSS>);
+  cube->beginModel ();
+  cube->addSubModel (vertices, triangles);
+  cube->endModel ();
+  robot->geomModel().addGeometryObject (se3::GeometryObject ("cube", 0, 0,
+        cube, Transform3f (matrix3_t::Identity(), cubeCenter)), robot->model());
+  robot->createGeomData();
+
+  const value_type resolution = .02;
+  BOOST_CHECK_THROW (DistanceField::create (robot, 1e-4, .2),
+                     std::invalid_argument);
+  DistanceFieldPtr_t field = DistanceField::create (robot, resolution, .2,
+                                                    true);
+  BOOST_CHECK(field->meshesFilled());
+  for (int i = 0; i < 100; ++i) {
+    vector3_t dir (vector3_t::Random().normalized());
+    const value_type d = radius + .05 + .1 * (i / 100.);
+    vector3_t gradient;
+    const value_type sdf = field->distance (center + d * dir, gradient);
+    BOOST_CHECK_SMALL(sdf - (d - radius), 2 * resolution);
+    BOOST_CHECK(gradient.normalized().dot (dir) > .9);
+  }
+  BOOST_CHECK(field->distance (center) < 0);
+  // The interior of the mesh is occupied.
+  BOOST_CHECK_SMALL(field->distance (cubeCenter) + half, 2 * resolution);
+  // Outside of the grid
+  BOOST_CHECK_SMALL(field->distance (center + vector3_t (1, 0, 0))
+      - (1 - radius), 2 * resolution);
+
+  // By default, only the surface of the mesh is occupied.
+  DistanceFieldPtr_t surface = DistanceField::create (robot, resolution, .2);
+  BOOST_CHECK(!surface->meshesFilled());
+  BOOST_CHECK_SMALL(surface->distance (cubeCenter) - half, 2 * resolution);
+  BOOST_CHECK_SMALL(surface->distance (center) - field->distance (center),
+                    1e-10);
+
+  char filename[] = "/tmp/hpp-pinocchio-distance-field-XXXXXX";
+  const int fd = mkstemp (filename);
+  BOOST_REQUIRE(fd != -1);
+  close (fd);
+  field->save (filename);
+  DistanceFieldPtr_t loaded = DistanceField::load (filename);
+  unlink (filename);
+  BOOST_CHECK(loaded->origin().isApprox (field->origin()));
+  BOOST_CHECK_EQUAL(loaded->resolution(), field->resolution());
+  BOOST_CHECK(loaded->dimensions() == field->dimensions());
+  BOOST_CHECK(loaded->values() == field->values());
+  BOOST_CHECK(loaded->meshesFilled());
+
+  // The loaded field is valid until an obstacle moves.
+  BOOST_CHECK(loaded->matches (robot));
+  robot->geomModel().geometryObjects.back().placement.translation()[2] += .1;
+  BOOST_CHECK(!loaded->matches (robot));
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE tgeodesic_segment
+
+#include <boost/test/unit_test.hpp>
+
+#include <pinocchio/algorithm/joint-configuration.hpp>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/geodesic-segment.hh>
+#include <hpp/pinocchio/simple-device.hh>
+
+using namespace hpp::pinocchio;
+
+BOOST_AUTO_TEST_CASE (evaluate)
+{
+  DevicePtr_t robot = humanoidSimple ("humanoid", true);
+  robot->setDimensionExtraConfigSpace (2);
+  robot->model().lowerPositionLimit.head<3>().setConstant(-1);
+  robot->model().upperPositionLimit.head<3>().setConstant( 1);
+
+  Configuration_t q0 (robot->configSize ()), q1 (robot->configSize ()),
+                  q (robot->configSize ()), expected (robot->configSize ());
+  q0.head (robot->model().nq) = se3::randomConfiguration (robot->model());
+  q1.head (robot->model().nq) = se3::randomConfiguration (robot->model());
+  q0.tail<2> ().setRandom ();
+  q1.tail<2> ().setRandom ();
+
+  GeodesicSegment segment (robot, q0, q1);
+  vector_t us (vector_t::LinSpaced (11, 0, 1));
+  matrix_t qs (robot->configSize (), us.size ());
+  segment.evaluate (us, qs);
+  vector_t velocity (robot->numberDof ());
+  for (size_type i = 0; i < us.size (); ++i) {
+    interpolate (robot, q0, q1, us [i], expected);
+    segment.evaluate (us [i], q);
+    BOOST_CHECK (isApprox (robot, q, expected, 1e-10));
+    segment.evaluate (us [i], q, velocity);
+    BOOST_CHECK (isApprox (robot, q, expected, 1e-10));
+    BOOST_CHECK (isApprox (robot, qs.col (i), expected, 1e-10));
+  }
+  BOOST_CHECK (qs.col (0) == q0);
+  BOOST_CHECK (qs.col (us.size () - 1) == q1);
+}
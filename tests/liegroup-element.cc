@@ -18,12 +18,19 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/list_of.hpp>
 #include <hpp/pinocchio/liegroup-element.hh>
+#include <hpp/pinocchio/block-diagonal-matrix.hh>
+#include <hpp/pinocchio/static-liegroup-space.hh>
+#include <hpp/pinocchio/liegroup-expression.hh>
+#include <hpp/pinocchio/liegroup-element-pool.hh>
 
 using boost::assign::list_of;
 using hpp::pinocchio::size_type;
 using hpp::pinocchio::value_type;
 using hpp::pinocchio::vector_t;
+using hpp::pinocchio::matrix_t;
+using hpp::pinocchio::BlockDiagonalMatrix;
 using hpp::pinocchio::LiegroupElement;
+using hpp::pinocchio::LiegroupElementRef;
 using hpp::pinocchio::LiegroupType;
 using hpp::pinocchio::LiegroupSpace;
 using hpp::pinocchio::LiegroupSpacePtr_t;
@@ -159,6 +166,43 @@ BOOST_AUTO_TEST_CASE (comparison)
   BOOST_CHECK (*(LiegroupSpace::Rn (2)) != *(LiegroupSpace::R2xSO2 ()));
 }
 
+BOOST_AUTO_TEST_CASE (canonical)
+{
+  BOOST_CHECK (!LiegroupSpace::R3 ()->isCanonical ());
+  BOOST_CHECK_EQUAL (LiegroupSpace::canonical (LiegroupSpace::SE3 ()),
+                     LiegroupSpace::canonical (LiegroupSpace::SE3 ()));
+
+  LiegroupSpacePtr_t R3 (LiegroupSpace::canonical (LiegroupSpace::R3 ()));
+  BOOST_CHECK (R3->isCanonical ());
+  BOOST_CHECK_EQUAL (R3->hash (), LiegroupSpace::create (3)->hash ());
+  BOOST_CHECK_EQUAL (LiegroupSpace::canonical (LiegroupSpace::create (3)), R3);
+  BOOST_CHECK_EQUAL (LiegroupSpace::canonical (LiegroupSpace::Rn (3)), R3);
+
+  // Instances returned by the factories can be modified.
+  LiegroupSpacePtr_t Rn (LiegroupSpace::Rn (3));
+  *Rn *= LiegroupSpace::R3 ();
+  Rn->mergeVectorSpaces ();
+  BOOST_CHECK_EQUAL (Rn->nq (), 6);
+  BOOST_CHECK (*R3 == *LiegroupSpace::R3 ());
+
+  LiegroupSpacePtr_t sp (LiegroupSpace::R3 () * LiegroupSpace::R3xSO3 ());
+  BOOST_CHECK (!sp->isCanonical ());
+  BOOST_CHECK (*sp != *LiegroupSpace::R3xSO3 ());
+  LiegroupSpacePtr_t c (LiegroupSpace::canonical (sp));
+  BOOST_CHECK (c != sp);
+  BOOST_CHECK (c->isCanonical ());
+  BOOST_CHECK (*c == *sp);
+  BOOST_CHECK_EQUAL (LiegroupSpace::canonical (c), c);
+  BOOST_CHECK_EQUAL (LiegroupSpace::canonical
+                     (LiegroupSpace::R3 () * LiegroupSpace::R3xSO3 ()), c);
+  BOOST_CHECK_THROW (*c *= LiegroupSpace::R3 (), std::logic_error);
+  BOOST_CHECK_THROW (c->mergeVectorSpaces (), std::logic_error);
+  // The argument of canonical is not frozen.
+  BOOST_CHECK (!sp->isCanonical ());
+  *sp *= LiegroupSpace::R3 ();
+  BOOST_CHECK (*sp != *c);
+}
+
 BOOST_AUTO_TEST_CASE (multiplication)
 {
   LiegroupSpacePtr_t sp (LiegroupSpace::Rn (10) * LiegroupSpace::R3 () *
@@ -216,3 +260,302 @@ BOOST_AUTO_TEST_CASE (log_)
   vector_t zero (9); zero.setZero ();
   BOOST_CHECK ((hpp::pinocchio::log (e) - zero).norm () < 1e-10);
 }
+
+BOOST_AUTO_TEST_CASE (operations)
+{
+  typedef LiegroupSpace::Operation Operation;
+  LiegroupSpacePtr_t sp (LiegroupSpace::Rn (10) * LiegroupSpace::R3 () *
+                         LiegroupSpace::R3xSO3 ());
+  *sp *= LiegroupSpace::create
+    (hpp::pinocchio::liegroup::SpecialOrthogonalOperation<3> ());
+  *sp *= LiegroupSpace::SE3 ();
+
+  const LiegroupSpace::Operations_t& ops (sp->operations ());
+  BOOST_REQUIRE_EQUAL (ops.size (), 3);
+  BOOST_CHECK_EQUAL (ops [0].kind, Operation::VECTOR_SPACE);
+  BOOST_CHECK_EQUAL (ops [0].nq, 16);
+  BOOST_CHECK_EQUAL (ops [1].kind, Operation::SO3);
+  BOOST_CHECK_EQUAL (ops [1].iq, 16);
+  BOOST_CHECK_EQUAL (ops [1].iv, 16);
+  BOOST_CHECK_EQUAL (ops [1].nq, 8);
+  BOOST_CHECK_EQUAL (ops [1].nv, 6);
+  BOOST_CHECK_EQUAL (ops [2].kind, Operation::SE3);
+  BOOST_CHECK_EQUAL (ops [2].iq, 24);
+  BOOST_CHECK_EQUAL (ops [2].iv, 22);
+
+  // log is the inverse of exp for small velocities.
+  for (std::size_t i=0; i<100; ++i) {
+    vector_t v (sp->nv ()); v.setRandom ();
+    LiegroupElement e (sp->exp (v));
+    BOOST_CHECK ((hpp::pinocchio::log (e) - v).norm () < 1e-8);
+    BOOST_CHECK ((e - sp->neutral () - v).norm () < 1e-8);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (inplace)
+{
+  LiegroupSpacePtr_t sp (LiegroupSpace::Rn (4) * LiegroupSpace::R3xSO3 ());
+  *sp *= LiegroupSpace::SE3 ();
+  vector_t v (sp->nv ()), d (sp->nv ()), l (sp->nv ());
+  LiegroupElement e0 (sp), e1 (sp);
+
+  for (std::size_t i=0; i<100; ++i) {
+    v.setRandom ();
+    e0 = sp->exp (v);
+    v.setRandom ();
+    hpp::pinocchio::integrate
+      (e0, v, LiegroupElementRef (e1.vector (), e1.space ()));
+    BOOST_CHECK ((e1.vector () - (e0 + v).vector ()).norm () < 1e-10);
+
+    hpp::pinocchio::difference (e1, e0, d);
+    BOOST_CHECK ((d - v).norm () < 1e-8);
+    BOOST_CHECK ((d - (e1 - e0)).norm () < 1e-10);
+
+    hpp::pinocchio::log (e1, l);
+    BOOST_CHECK ((l - hpp::pinocchio::log (e1)).norm () < 1e-10);
+
+    // Integration in place
+    hpp::pinocchio::integrate
+      (e0, v, LiegroupElementRef (e0.vector (), e0.space ()));
+    BOOST_CHECK ((e0.vector () - e1.vector ()).norm () < 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (blockDiagonalJacobian)
+{
+  LiegroupSpacePtr_t sp (LiegroupSpace::Rn (4) * LiegroupSpace::R3xSO3 ());
+  *sp *= LiegroupSpace::SE3 ();
+  *sp *= LiegroupSpace::Rn (2);
+  const size_type nv (sp->nv ());
+  vector_t v (nv);
+  BlockDiagonalMatrix B, B0, B1;
+
+  for (std::size_t i=0; i<10; ++i) {
+    v.setRandom ();
+    LiegroupElement q0 (sp->exp (v));
+    v.setRandom ();
+    LiegroupElement q1 (sp->exp (v));
+
+    matrix_t J (matrix_t::Identity (nv, nv));
+    sp->Jintegrate (v, J);
+    sp->Jintegrate (v, B);
+    BOOST_CHECK_EQUAL (B.blocks ().size (), 4);
+    BOOST_CHECK ((B.matrix () - J).norm () < 1e-10);
+
+    matrix_t M (matrix_t::Random (nv, 7)), BM (M);
+    B.applyOnTheLeft (BM);
+    BOOST_CHECK ((BM - J * M).norm () < 1e-10);
+    matrix_t N (matrix_t::Random (7, nv)), NB (N);
+    B.applyOnTheRight (NB);
+    BOOST_CHECK ((NB - N * J).norm () < 1e-10);
+
+    matrix_t J0 (matrix_t::Identity (nv, nv)), J1 (J0);
+    sp->Jdifference<true> (q0.vector (), q1.vector (), J0, J1);
+    sp->Jdifference (q0.vector (), q1.vector (), B0, B1);
+    BOOST_CHECK ((B0.matrix () - J0).norm () < 1e-10);
+    BOOST_CHECK ((B1.matrix () - J1).norm () < 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (staticLiegroupSpace)
+{
+  namespace liegroup = hpp::pinocchio::liegroup;
+  typedef liegroup::CartesianProductOperation <
+    liegroup::SpecialEuclideanOperation <3>,
+    liegroup::CartesianProductOperation <
+      liegroup::VectorSpaceOperation <1, true>,
+      liegroup::CartesianProductOperation <
+        liegroup::SpecialOrthogonalOperation <2>,
+        liegroup::VectorSpaceOperation <4, false> > > > LieGroup;
+  typedef hpp::pinocchio::StaticLiegroupSpace <LieGroup> Space;
+
+  BOOST_CHECK_EQUAL ((int)Space::NQ, 14);
+  BOOST_CHECK_EQUAL ((int)Space::NV, 12);
+
+  LiegroupSpacePtr_t sp (Space::dynamicSpace ());
+  BOOST_CHECK (sp->isCanonical ());
+  BOOST_CHECK_EQUAL (sp, Space::dynamicSpace ());
+  BOOST_CHECK_EQUAL (sp->liegroupTypes ().size (), 4);
+  BOOST_CHECK_EQUAL (sp->nq (), Space::nq ());
+  BOOST_CHECK_EQUAL (sp->nv (), Space::nv ());
+  BOOST_CHECK (Space::isCompatible (*sp));
+  BOOST_CHECK (!Space::isCompatible (*LiegroupSpace::SE3 ()));
+  BOOST_CHECK ((Space::neutral () - sp->neutral ().vector ()).norm () < 1e-12);
+
+  Space::ConfigVector_t q0, q1;
+  Space::TangentVector_t v, d;
+  Space::JacobianMatrix_t J, J0, J1;
+  for (std::size_t i=0; i<10; ++i) {
+    v.setRandom ();
+    Space::exp (v, q0);
+    BOOST_CHECK ((Space::element (q0).vector () - sp->exp (v).vector ())
+                 .norm () < 1e-10);
+
+    v.setRandom ();
+    Space::integrate (q0, v, q1);
+    LiegroupElement e0 (Space::element (q0)), e1 (e0 + v);
+    BOOST_CHECK ((Space::vector (e1) - q1).norm () < 1e-10);
+
+    Space::difference (q0, q1, d);
+    BOOST_CHECK ((d - (e1 - e0)).norm () < 1e-10);
+
+    // The Jacobians are applied to the input matrices.
+    matrix_t Jd (matrix_t::Random (12, 7));
+    matrix_t Js (Jd);
+    Space::Jintegrate (v, Js);
+    sp->Jintegrate (v, Jd);
+    BOOST_CHECK ((Js - Jd).norm () < 1e-10);
+
+    J.setRandom ();
+    J0 = J; J1 = J;
+    matrix_t Jd0 (J), Jd1 (J);
+    Space::Jdifference<true> (q0, q1, J0, J1);
+    sp->Jdifference<true> (q0, q1, Jd0, Jd1);
+    BOOST_CHECK ((J0 - Jd0).norm () < 1e-10);
+    BOOST_CHECK ((J1 - Jd1).norm () < 1e-10);
+
+    matrix_t Jr (matrix_t::Random (5, 12));
+    matrix_t Jr0 (Jr), Jr1 (Jr), Jdr0 (Jr), Jdr1 (Jr);
+    Space::Jdifference<false> (q0, q1, Jr0, Jr1);
+    sp->Jdifference<false> (q0, q1, Jdr0, Jdr1);
+    BOOST_CHECK ((Jr0 - Jdr0).norm () < 1e-10);
+    BOOST_CHECK ((Jr1 - Jdr1).norm () < 1e-10);
+  }
+  BOOST_CHECK_THROW (Space::vector (LiegroupSpace::SE3 ()->neutral ()),
+                     std::invalid_argument);
+}
+
+// Runs of SO(3) and SE(3) long enough to use the batch kernels are compared
+// to the same operations element by element.
+BOOST_AUTO_TEST_CASE (batch)
+{
+  const size_type nSE3 (11), nSO3 (5);
+  LiegroupSpacePtr_t sp (LiegroupSpace::empty ());
+  for (size_type i = 0; i < nSE3; ++i) *sp *= LiegroupSpace::SE3 ();
+  for (size_type i = 0; i < nSO3; ++i)
+    *sp *= LiegroupSpace::create
+      (hpp::pinocchio::liegroup::SpecialOrthogonalOperation<3> ());
+  BOOST_REQUIRE_EQUAL (sp->operations ().size (), 2);
+  LiegroupSpacePtr_t SO3 (LiegroupSpace::create
+      (hpp::pinocchio::liegroup::SpecialOrthogonalOperation<3> ()));
+
+  vector_t v (sp->nv ()), d (sp->nv ());
+  for (std::size_t i=0; i<20; ++i) {
+    v.setRandom ();
+    // Include small velocities
+    if (i % 4 == 0) v *= 1e-5;
+    LiegroupElement e0 (sp->exp (v));
+    v.setRandom ();
+    if (i % 4 == 1) v *= 1e-5;
+    LiegroupElement e1 (e0 + v);
+    hpp::pinocchio::difference (e1, e0, d);
+
+    for (size_type k = 0; k < nSE3 + nSO3; ++k) {
+      const bool se3 (k < nSE3);
+      const size_type iq (se3 ? 7*k : 7*nSE3 + 4*(k-nSE3)),
+                      iv (se3 ? 6*k : 6*nSE3 + 3*(k-nSE3)),
+                      nq (se3 ? 7 : 4), nv (se3 ? 6 : 3);
+      LiegroupSpacePtr_t space (se3 ? LiegroupSpace::SE3 () : SO3);
+      LiegroupElement a0 (e0.vector ().segment (iq, nq), space),
+                      a1 (e1.vector ().segment (iq, nq), space);
+      // Quaternions may differ by their sign.
+      BOOST_CHECK ((a1 - (a0 + v.segment (iv, nv))).norm () < 1e-10);
+      BOOST_CHECK ((d.segment (iv, nv) - (a1 - a0)).norm () < 1e-8);
+      BOOST_CHECK ((d.segment (iv, nv) - v.segment (iv, nv)).norm () < 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE (expression)
+{
+  using hpp::pinocchio::lazy;
+  using hpp::pinocchio::evaluate;
+  LiegroupSpacePtr_t sp (LiegroupSpace::Rn (10) * LiegroupSpace::R2xSO2 ());
+  *sp *= LiegroupSpace::SE3 ();
+  *sp *= LiegroupSpace::R3xSO3 ();
+  *sp *= LiegroupSpace::SE2 ();
+
+  vector_t v0 (sp->nv ()), v1 (sp->nv ()), v2 (sp->nv ()), d (sp->nv ());
+  LiegroupElement q2 (sp);
+  for (std::size_t i=0; i<20; ++i) {
+    v0.setRandom (); v1.setRandom (); v2.setRandom ();
+    const LiegroupElement q0 (sp->exp (v0)), q1 (q0 + v1);
+
+    evaluate (lazy (q0) + v1 + v2, LiegroupElementRef (q2.vector (), sp));
+    BOOST_CHECK (((q0 + v1) + v2 - q2).norm () < 1e-10);
+
+    // Interpolation
+    const value_type u (.3);
+    LiegroupElement qu (evaluate (lazy (q0) + (lazy (q1) - q0) * u));
+    BOOST_CHECK (((q0 + u * (q1 - q0)) - qu).norm () < 1e-10);
+
+    // Eigen expressions as tangent vectors
+    evaluate (lazy (q0) + v1 * u + (v2 - v1),
+              LiegroupElementRef (q2.vector (), sp));
+    BOOST_CHECK (((q0 + vector_t (v1 * u)) + vector_t (v2 - v1) - q2).norm ()
+                 < 1e-10);
+
+    evaluate (*sp, 2 * (lazy (q1) - q0), d);
+    BOOST_CHECK ((d - 2 * (q1 - q0)).norm () < 1e-10);
+
+    // Evaluation in place
+    q2 = q0;
+    evaluate (lazy (q2) + v1, LiegroupElementRef (q2.vector (), sp));
+    BOOST_CHECK ((q1 - q2).norm () < 1e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (pool)
+{
+  using hpp::pinocchio::LiegroupElementPool;
+  using hpp::pinocchio::LiegroupElementView;
+  using hpp::pinocchio::LiegroupConstElementView;
+  LiegroupSpacePtr_t sp (LiegroupSpace::Rn (3) * LiegroupSpace::SE3 ());
+  *sp *= LiegroupSpace::R2xSO2 ();
+  const size_type n (50);
+
+  LiegroupElementPool pool (sp);
+  std::vector <LiegroupElement> elements;
+  vector_t v (sp->nv ());
+  for (size_type i = 0; i < n; ++i) {
+    v.setRandom ();
+    elements.push_back (sp->exp (v));
+    BOOST_CHECK_EQUAL (pool.push_back (elements.back ()), i);
+  }
+  BOOST_CHECK_EQUAL (pool.size (), n);
+  BOOST_CHECK (pool.capacity () >= n);
+  for (size_type i = 0; i < n; ++i) {
+    BOOST_CHECK (pool [i].vector () == elements [i].vector ());
+    BOOST_CHECK_EQUAL (pool [i].space (), sp.get ());
+  }
+
+  // Bulk operations
+  matrix_t V (matrix_t::Random (sp->nv (), n)), D (sp->nv (), n);
+  LiegroupElementPool pool0 (pool);
+  pool.integrate (V);
+  pool.difference (pool0, D);
+  BOOST_CHECK ((D - V).norm () < 1e-8);
+  pool.difference (elements [0].vector (), D);
+  for (size_type i = 0; i < n; ++i) {
+    BOOST_CHECK ((pool.element (i).vector ()
+                  - (elements [i] + V.col (i)).vector ()).norm () < 1e-10);
+    BOOST_CHECK ((D.col (i) - (pool.element (i) - elements [0])).norm ()
+                 < 1e-10);
+  }
+  pool.log (D);
+  BOOST_CHECK ((D.col (3) - hpp::pinocchio::log (pool.element (3))).norm ()
+               < 1e-10);
+
+  // Views
+  LiegroupConstElementView e0 (pool0 [0]);
+  LiegroupElementView e1 (pool [1]);
+  hpp::pinocchio::integrate (e0, V.col (1), e1);
+  hpp::pinocchio::difference (e1, e0, v);
+  BOOST_CHECK ((v - V.col (1)).norm () < 1e-8);
+  hpp::pinocchio::integrate (e1, V.col (2), e1);
+  BOOST_CHECK ((pool.element (1).vector () - ((elements [0] + V.col (1))
+          + V.col (2)).vector ()).norm () < 1e-10);
+
+  pool.resize (n + 2);
+  BOOST_CHECK (pool [n + 1].vector () == sp->neutral ().vector ());
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2018, CNRS
+// Authors: Joseph Mirabel (joseph.mirabel@laas.fr)
+//
+// This file is part of hpp-pinocchio.
+// hpp-pinocchio is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-pinocchio is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-pinocchio. If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE tnearest_neighbor
+
+#include <boost/test/unit_test.hpp>
+
+#include <pinocchio/algorithm/joint-configuration.hpp>
+
+#include <hpp/pinocchio/device.hh>
+#include <hpp/pinocchio/configuration.hh>
+#include <hpp/pinocchio/nearest-neighbor.hh>
+#include <hpp/pinocchio/simple-device.hh>
+
+using namespace hpp::pinocchio;
+
+DevicePtr_t makeRobot ()
+{
+  DevicePtr_t robot = humanoidSimple ("humanoid", true);
+  robot->model().lowerPositionLimit.head<3>().setConstant(-1);
+  robot->model().upperPositionLimit.head<3>().setConstant( 1);
+  return robot;
+}
+
+size_type linearSearch (const DevicePtr_t& robot,
+    const std::vector<Configuration_t>& qs, ConfigurationIn_t q,
+    value_type& dmin)
+{
+  size_type best = -1;
+  dmin = std::numeric_limits<value_type>::infinity();
+  for (std::size_t i = 0; i < qs.size(); ++i) {
+    value_type d = distance (robot, q, qs[i]);
+    if (d < dmin) { dmin = d; best = (size_type)i; }
+  }
+  return best;
+}
+
+BOOST_AUTO_TEST_CASE (nearest)
+{
+  DevicePtr_t robot = makeRobot ();
+  NearestNeighborPtr_t nn = NearestNeighbor::create (robot, 4);
+
+  std::vector<Configuration_t> qs;
+  for (size_type i = 0; i < 500; ++i) {
+    qs.push_back (se3::randomConfiguration (robot->model()));
+    BOOST_CHECK_EQUAL (nn->add (qs.back()), i);
+  }
+  BOOST_CHECK_EQUAL (nn->size(), 500);
+
+  for (size_type i = 0; i < 50; ++i) {
+    Configuration_t q = se3::randomConfiguration (robot->model());
+    value_type d, dExpected;
+    size_type expected = linearSearch (robot, qs, q, dExpected);
+    size_type res = nn->search (q, d);
+    BOOST_CHECK_EQUAL (res, expected);
+    BOOST_CHECK_CLOSE (d, dExpected, 1e-8);
+
+    // Approximate search
+    nn->search (q, d, 0.5);
+    BOOST_CHECK (d <= 1.5 * dExpected + 1e-10);
+
+    // k nearest neighbors are sorted and the first one is the nearest.
+    NearestNeighbor::Indexes_t indexes;
+    NearestNeighbor::Distances_t distances;
+    nn->search (q, 10, indexes, distances);
+    BOOST_REQUIRE_EQUAL (indexes.size(), 10);
+    BOOST_CHECK_EQUAL (indexes[0], expected);
+    for (std::size_t k = 1; k < distances.size(); ++k)
+      BOOST_CHECK (distances[k-1] <= distances[k]);
+
+    // Ball search returns exactly the configurations within the radius.
+    const value_type radius = distances.back();
+    nn->withinBall (q, radius, indexes, distances);
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < qs.size(); ++k)
+      if (distance (robot, q, qs[k]) <= radius) ++count;
+    BOOST_CHECK_EQUAL (indexes.size(), count);
+  }
+}